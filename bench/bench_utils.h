@@ -0,0 +1,51 @@
+/**
+ * @file	bench_utils.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_BENCH_BENCH_UTILS_H_
+#define JCU_UNIO_BENCH_BENCH_UTILS_H_
+
+#include <stdio.h>
+
+#include <chrono>
+
+namespace bench {
+
+/**
+ * Prevent the compiler from optimizing away the value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T* sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * @return nanoseconds per iteration
+ */
+template <typename F>
+double measure(size_t iterations, F&& fn) {
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    fn(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) iterations;
+}
+
+inline void report(const char* name, double ns_per_op) {
+  printf("%-48s %12.1f ns/op\n", name, ns_per_op);
+}
+
+} // namespace bench
+
+#endif //JCU_UNIO_BENCH_BENCH_UTILS_H_
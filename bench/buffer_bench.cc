@@ -0,0 +1,88 @@
+/**
+ * @file	buffer_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstring>
+
+#include <jcu-unio/buffer.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+/**
+ * Same as TCPSocketImpl::allocCallback + readCallback,
+ * libuv suggests 64KiB and the kernel fills only nread bytes.
+ */
+static void simulateRead(Buffer* buffer, size_t suggested_size, size_t nread) {
+  buffer->clear();
+  size_t buffer_remaining = buffer->remaining();
+  if (buffer_remaining < suggested_size) {
+    buffer->expand(buffer->capacity() + (suggested_size - buffer_remaining));
+  }
+  std::memset(buffer->data(), 0x5a, nread);
+  buffer->limit(buffer->position() + nread);
+  bench::doNotOptimize(*(const char*) buffer->data());
+}
+
+/**
+ * Per-read bookkeeping only (allocCallback + readCallback + consuming the data),
+ * instantiated for Buffer (virtual calls) and FlatBuffer (inlined)
+ */
+template <class T>
+static void bookkeepRead(T* buffer, size_t suggested_size, size_t nread) {
+  buffer->clear();
+  size_t buffer_remaining = buffer->remaining();
+  if (buffer_remaining < suggested_size) {
+    buffer->expand(buffer->capacity() + (suggested_size - buffer_remaining));
+  }
+  bench::doNotOptimize(buffer->data());
+  buffer->limit(buffer->position() + nread);
+  buffer->position(buffer->position() + buffer->remaining());
+  bench::doNotOptimize(buffer->position());
+}
+
+template <class T>
+static void benchReadBookkeeping(const char* name, T* buffer) {
+  double ns = bench::measure(10000000, [&](size_t i) -> void {
+    bookkeepRead(buffer, 65536, 1500);
+  });
+  bench::report(name, ns);
+}
+
+static void benchExpandPerConnection(const char* name, const BufferOptions& options) {
+  double ns = bench::measure(20000, [&](size_t i) -> void {
+    auto buffer = createExpandableBuffer(4096, 1048576, options);
+    simulateRead(buffer.get(), 65536, 1500);
+  });
+  bench::report(name, ns);
+}
+
+static void benchLargeExpand(const char* name, const BufferOptions& options) {
+  double ns = bench::measure(2000, [&](size_t i) -> void {
+    auto buffer = createExpandableBuffer(4096, 4194304, options);
+    simulateRead(buffer.get(), 4194304, 4096);
+  });
+  bench::report(name, ns);
+}
+
+int main() {
+  BufferOptions zero_fill;
+  BufferOptions uninitialized;
+  uninitialized.zero_fill = false;
+
+  benchExpandPerConnection("expand 4K->64K, 1500B read (zero_fill)", zero_fill);
+  benchExpandPerConnection("expand 4K->64K, 1500B read (uninitialized)", uninitialized);
+  benchLargeExpand("expand 4K->4M, 4K read (zero_fill)", zero_fill);
+  benchLargeExpand("expand 4K->4M, 4K read (uninitialized)", uninitialized);
+
+  auto buffer = createFixedSizeBuffer(65536);
+  benchReadBookkeeping("per-read bookkeeping (Buffer, virtual)", buffer.get());
+  benchReadBookkeeping("per-read bookkeeping (FlatBuffer, inlined)", FlatBuffer::from(buffer.get()));
+  return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file	buffer_scan_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <jcu-unio/buffer_scan.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const size_t kSize = 65536;
+static const size_t kIterations = 20000;
+
+static size_t naiveFindByte(const uint8_t* data, size_t size, uint8_t value) {
+  for (size_t i = 0; i < size; i++) {
+    if (data[i] == value) return i;
+  }
+  return kScanNotFound;
+}
+
+static size_t naiveFindAnyOf(const uint8_t* data, size_t size, const char* set, size_t set_size) {
+  for (size_t i = 0; i < size; i++) {
+    for (size_t j = 0; j < set_size; j++) {
+      if (data[i] == (uint8_t) set[j]) return i;
+    }
+  }
+  return kScanNotFound;
+}
+
+static size_t naiveFindCrlfCrlf(const uint8_t* data, size_t size) {
+  for (size_t i = 0; i + 4 <= size; i++) {
+    if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') return i;
+  }
+  return kScanNotFound;
+}
+
+static size_t naiveCountNewlines(const uint8_t* data, size_t size) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) {
+    count += (data[i] == '\n');
+  }
+  return count;
+}
+
+template <typename F>
+static void run(const char* name, F&& fn) {
+  double ns = bench::measure(kIterations, [&](size_t i) -> void {
+    bench::doNotOptimize(fn());
+  });
+  bench::report(name, ns);
+}
+
+int main() {
+  // header-like text: lines of 64 bytes, the terminator and the delimiters at the end
+  std::string text;
+  while (text.size() < kSize - 4) {
+    text.append(62, 'a');
+    text.append("\r\n");
+  }
+  text.resize(kSize - 4);
+  text.append("\r\n\r\n");
+  text[kSize - 5] = ';';
+  const uint8_t* data = (const uint8_t*) text.data();
+  std::string plain(kSize, 'a');
+  plain[kSize - 1] = '\n';
+  const uint8_t* plain_data = (const uint8_t*) plain.data();
+
+  printf("implementation: %s, %zu bytes per op\n", getScanImplementation(), kSize);
+
+  run("findByte (last byte)", [&]() { return findByte(plain_data, kSize, '\n'); });
+  run("memchr (last byte)", [&]() { return (const void*) std::memchr(plain_data, '\n', kSize); });
+  run("naive findByte (last byte)", [&]() { return naiveFindByte(plain_data, kSize, '\n'); });
+
+  run("findAnyOf ';#' (near the end)", [&]() { return findAnyOf(data, kSize, ";#", 2); });
+  run("naive findAnyOf ';#' (near the end)", [&]() { return naiveFindAnyOf(data, kSize, ";#", 2); });
+
+  run("findCrlfCrlf (at the end)", [&]() { return findCrlfCrlf(data, kSize); });
+  run("naive findCrlfCrlf (at the end)", [&]() { return naiveFindCrlfCrlf(data, kSize); });
+
+  run("countNewlines", [&]() { return countNewlines(data, kSize); });
+  run("naive countNewlines", [&]() { return naiveCountNewlines(data, kSize); });
+  return 0;
+}
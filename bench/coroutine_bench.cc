@@ -0,0 +1,156 @@
+/**
+ * @file	coroutine_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <stdio.h>
+
+#include <future>
+#include <thread>
+
+#include <jcu-unio/coroutine.h>
+#include <jcu-unio/event.h>
+#include <jcu-unio/loop.h>
+#include <jcu-unio/resource.h>
+
+#include "bench_utils.h"
+
+#if defined(JCU_UNIO_HAS_COROUTINE)
+
+using namespace ::jcu::unio;
+
+static const size_t kHops = 1000000;
+static const size_t kCalls = 10000000;
+
+class DummyResource : public Resource {
+ protected:
+  std::shared_ptr<Resource> sharedAsResource() override {
+    return nullptr;
+  }
+
+ public:
+  void close() override {}
+};
+
+struct CountEvent {
+  int value;
+};
+
+/**
+ * Each step is posted to the loop by the previous one, like a callback chain
+ */
+static double callbackHops(const std::shared_ptr<Loop>& loop) {
+  struct Chain {
+    std::shared_ptr<Loop> loop;
+    size_t remaining;
+    std::promise<void> done;
+
+    void step() {
+      if (--remaining == 0) {
+        done.set_value();
+        return ;
+      }
+      loop->post([this]() -> void {
+        step();
+      });
+    }
+  } chain { loop, kHops };
+  std::future<void> f_done = chain.done.get_future();
+  auto begin = std::chrono::steady_clock::now();
+  loop->post([&]() -> void {
+    chain.step();
+  });
+  f_done.wait();
+  auto end = std::chrono::steady_clock::now();
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kHops;
+}
+
+static Task<> scheduleLoop(std::shared_ptr<Loop> loop, std::promise<void>& done) {
+  for (size_t i = 0; i < kHops; i++) {
+    co_await loop->schedule();
+  }
+  done.set_value();
+}
+
+static double coroutineHops(const std::shared_ptr<Loop>& loop) {
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  auto begin = std::chrono::steady_clock::now();
+  scheduleLoop(loop, p_done).detach();
+  f_done.wait();
+  auto end = std::chrono::steady_clock::now();
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kHops;
+}
+
+/**
+ * Completion delivered through CompletionOnceCallback
+ */
+static double callbackCompletion() {
+  DummyResource resource;
+  int sum = 0;
+  double ns = bench::measure(kCalls, [&](size_t i) -> void {
+    CompletionOnceCallback<CountEvent> callback = [&sum](CountEvent& event, Resource& handle) -> void {
+      sum += event.value;
+    };
+    // stored and called later on the real path
+    bench::doNotOptimize(callback);
+    CountEvent event { (int) i };
+    callback(event, resource);
+  });
+  bench::doNotOptimize(sum);
+  return ns;
+}
+
+static Task<int> produce(int value) {
+  co_return value;
+}
+
+static Task<> consume(int* sum, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    *sum += co_await produce((int) i);
+  }
+}
+
+/**
+ * Completion delivered by co_await of a Task (frame from the pool)
+ */
+static double taskCompletion() {
+  int sum = 0;
+  auto begin = std::chrono::steady_clock::now();
+  consume(&sum, kCalls).detach();
+  auto end = std::chrono::steady_clock::now();
+  bench::doNotOptimize(sum);
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kCalls;
+}
+
+int main() {
+  auto loop = SharedLoop::create();
+  std::thread loop_thread([loop]() -> void {
+    loop->init();
+    uv_run(loop->get(), UV_RUN_DEFAULT);
+  });
+
+  bench::report("loop hop: posted callback chain", callbackHops(loop));
+  bench::report("loop hop: co_await loop->schedule()", coroutineHops(loop));
+  bench::report("completion: CompletionOnceCallback", callbackCompletion());
+  bench::report("completion: co_await Task<int>", taskCompletion());
+
+  loop->post([loop]() -> void {
+    loop->uninit();
+  });
+  loop_thread.join();
+  return 0;
+}
+
+#else
+
+int main() {
+  printf("coroutines are not supported by this compiler\n");
+  return 0;
+}
+
+#endif // JCU_UNIO_HAS_COROUTINE
@@ -0,0 +1,137 @@
+/**
+ * @file	emitter_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <jcu-unio/handle.h>
+#include <jcu-unio/net/socket.h>
+#include <jcu-unio/net/stream_socket.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const size_t kEmits = 10000000;
+
+/**
+ * The previous Emitter lookup: typeid hash, unordered_map and dynamic_cast
+ */
+class LegacyEmitter {
+ public:
+  virtual ~LegacyEmitter() = default;
+
+  class BaseHandler {
+   public:
+    virtual ~BaseHandler() = default;
+  };
+
+  template <typename U>
+  class Handler : public BaseHandler {
+   public:
+    std::list<std::function<void(U& event, Resource& handle)>> callbacks_;
+  };
+
+  template <typename U>
+  void on(std::function<void(U& event, Resource& handle)> callback) {
+    auto& p = handlers_[typeid(U).hash_code()];
+    if (!p) {
+      p.reset(new Handler<U>());
+    }
+    static_cast<Handler<U>*>(p.get())->callbacks_.emplace_back(std::move(callback));
+  }
+
+  template <typename U>
+  int emit(U& event) {
+    auto it = handlers_.find(typeid(U).hash_code());
+    if (it != handlers_.end()) {
+      Handler<U>* handler = dynamic_cast<Handler<U>*>(it->second.get());
+      if (handler) {
+        int count = 0;
+        for (auto& callback : handler->callbacks_) {
+          callback(event, dynamic_cast<Resource&>(*this));
+          count++;
+        }
+        return count;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  std::unordered_map<size_t, std::unique_ptr<BaseHandler>> handlers_;
+};
+
+class LegacyHandle : public Resource, public LegacyEmitter {
+ protected:
+  std::shared_ptr<Resource> sharedAsResource() override {
+    return nullptr;
+  }
+
+ public:
+  void close() override {}
+};
+
+class BenchHandle : public Handle {
+ protected:
+  std::shared_ptr<Resource> sharedAsResource() override {
+    return nullptr;
+  }
+
+  void _init() override {}
+
+ public:
+  void close() override {}
+
+  template <typename U>
+  int emitEvent(U& event) {
+    return emit(event);
+  }
+};
+
+/**
+ * Listeners of a typical socket, the read one is emitted
+ */
+template <typename E>
+static double emitRead(E& emitter) {
+  size_t total = 0;
+  emitter.template on<InitEvent>([](InitEvent& event, Resource& handle) -> void {});
+  emitter.template on<CloseEvent>([](CloseEvent& event, Resource& handle) -> void {});
+  emitter.template on<SocketConnectEvent>([](SocketConnectEvent& event, Resource& handle) -> void {});
+  emitter.template on<SocketWriteEvent>([](SocketWriteEvent& event, Resource& handle) -> void {});
+  emitter.template on<SocketReadEvent>([&total](SocketReadEvent& event, Resource& handle) -> void {
+    total++;
+  });
+  SocketReadEvent event((Buffer*) nullptr);
+  double ns = bench::measure(kEmits, [&](size_t i) -> void {
+    bench::doNotOptimize(emitter);
+    emitter.emitEvent(event);
+  });
+  bench::doNotOptimize(total);
+  return ns;
+}
+
+class LegacyBenchHandle : public LegacyHandle {
+ public:
+  template <typename U>
+  int emitEvent(U& event) {
+    return emit(event);
+  }
+};
+
+int main() {
+  LegacyBenchHandle legacy;
+  BenchHandle handle;
+  bench::report("emit SocketReadEvent: typeid + unordered_map", emitRead(legacy));
+  bench::report("emit SocketReadEvent: EventTypeId + vector", emitRead(handle));
+  return 0;
+}
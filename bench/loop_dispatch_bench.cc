@@ -0,0 +1,117 @@
+/**
+ * @file	loop_dispatch_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <jcu-unio/loop.h>
+#include <jcu-unio/log.h>
+#include <jcu-unio/timer.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const size_t kTasks = 1000000;
+static const size_t kHandles = 20000;
+
+/**
+ * Wait until the tasks queued so far have run
+ */
+static void drain(const std::shared_ptr<Loop>& loop) {
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  loop->post([&]() -> void {
+    p_done.set_value();
+  });
+  f_done.wait();
+}
+
+static void runOnLoop(const std::shared_ptr<Loop>& loop, QueuedTask_t&& task) {
+  loop->post(std::move(task));
+  drain(loop);
+}
+
+/**
+ * Tasks sent from a loop callback
+ */
+static double sendFromLoop(const std::shared_ptr<Loop>& loop, bool dispatch) {
+  size_t executed = 0;
+  auto begin = std::chrono::steady_clock::now();
+  runOnLoop(loop, [&]() -> void {
+    for (size_t i = 0; i < kTasks; i++) {
+      auto task = [&]() -> void { executed++; };
+      if (dispatch) {
+        loop->dispatch(task);
+      } else {
+        loop->post(task);
+      }
+    }
+  });
+  // the posted ones are run after the marker of runOnLoop
+  drain(loop);
+  auto end = std::chrono::steady_clock::now();
+  bench::doNotOptimize(executed);
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kTasks;
+}
+
+/**
+ * Timer::create until the handle is initialized
+ */
+static double createHandles(const BasicParams& basic_params, bool from_loop) {
+  std::vector<std::shared_ptr<Timer>> handles;
+  handles.reserve(kHandles);
+  auto create = [&]() -> void {
+    for (size_t i = 0; i < kHandles; i++) {
+      handles.emplace_back(Timer::create(basic_params));
+    }
+  };
+  auto begin = std::chrono::steady_clock::now();
+  if (from_loop) {
+    runOnLoop(basic_params.loop, create);
+  } else {
+    create();
+    drain(basic_params.loop);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  runOnLoop(basic_params.loop, [&]() -> void {
+    for (auto& handle : handles) {
+      handle->close();
+    }
+  });
+  drain(basic_params.loop);
+  handles.clear();
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kHandles;
+}
+
+int main() {
+  BasicParams basic_params;
+  basic_params.logger = createDefaultLogger([](Logger::LogLevel level, const std::string& text) -> void {});
+  basic_params.loop = SharedLoop::create();
+  auto loop = basic_params.loop;
+  std::thread loop_thread([loop]() -> void {
+    loop->init();
+    uv_run(loop->get(), UV_RUN_DEFAULT);
+  });
+  drain(loop);
+
+  bench::report("post from the loop thread", sendFromLoop(loop, false));
+  bench::report("dispatch from the loop thread", sendFromLoop(loop, true));
+  bench::report("Timer::create from another thread", createHandles(basic_params, false));
+  bench::report("Timer::create from the loop thread", createHandles(basic_params, true));
+
+  loop->post([loop]() -> void {
+    loop->uninit();
+  });
+  loop_thread.join();
+  return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file	loop_queue_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <jcu-unio/loop.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const size_t kTotalTasks = 2000000;
+
+/**
+ * Producer threads post tasks to one loop thread
+ *
+ * @return nanoseconds per task (from the first post until the loop has run every task)
+ */
+static double contend(int producers, bool metrics) {
+  auto loop = SharedLoop::create();
+  loop->init();
+  if (metrics) {
+    loop->enableMetrics();
+  }
+  std::thread loop_thread([loop]() -> void {
+    uv_run(loop->get(), UV_RUN_DEFAULT);
+  });
+
+  size_t tasks_per_producer = kTotalTasks / producers;
+  size_t total = tasks_per_producer * producers;
+  size_t executed = 0;
+  std::atomic<bool> done(false);
+  std::atomic<bool> start(false);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < producers; i++) {
+    threads.emplace_back([&]() -> void {
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      for (size_t n = 0; n < tasks_per_producer; n++) {
+        loop->sendQueuedTask([&]() -> void {
+          // runs on the loop thread only
+          if (++executed == total) {
+            done.store(true);
+          }
+        });
+      }
+    });
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (!done.load()) {
+    std::this_thread::yield();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  loop->sendQueuedTask([loop]() -> void {
+    loop->uninit();
+  });
+  loop_thread.join();
+
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) total;
+}
+
+int main() {
+  char name[64];
+  for (int producers = 1; producers <= 32; producers *= 2) {
+    snprintf(name, sizeof(name), "sendQueuedTask, %d producers", producers);
+    bench::report(name, contend(producers, false));
+  }
+  // overhead of the loop metrics (queued task wait time)
+  bench::report("sendQueuedTask, 1 producers, metrics", contend(1, true));
+  return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file	mapped_file_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include <jcu-unio/loop.h>
+#include <jcu-unio/log.h>
+#include <jcu-unio/net/tcp_socket.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const char* kFilePath = "jcu_unio_bench_file.bin";
+static const size_t kFileSize = 64 * 1024 * 1024;
+static const int kRounds = 8;
+
+static std::shared_ptr<Buffer> readFile() {
+  auto buffer = createFixedSizeBuffer(kFileSize);
+  FILE* fp = fopen(kFilePath, "rb");
+  size_t n = fread(buffer->data(), 1, kFileSize, fp);
+  fclose(fp);
+  buffer->position(n);
+  buffer->flip();
+  return buffer;
+}
+
+static std::shared_ptr<Buffer> mapFile() {
+  return createMappedFileBuffer(kFilePath);
+}
+
+/**
+ * Serve the file to a loopback TCP client and wait until it has received everything
+ *
+ * @return nanoseconds per round
+ */
+static double serve(unsigned int port, const std::function<std::shared_ptr<Buffer>()>& load) {
+  BasicParams basic_params;
+  basic_params.loop = SharedLoop::create();
+  basic_params.logger = createDefaultLogger(nullptr);
+  basic_params.loop->init();
+
+  auto server = TCPSocket::create(basic_params);
+  auto client = TCPSocket::create(basic_params);
+  std::shared_ptr<TCPSocket> peer;
+  size_t received = 0;
+  int round = 0;
+  auto begin = std::chrono::steady_clock::now();
+  auto end = begin;
+  // the buffer must stay alive until the write completes
+  std::shared_ptr<Buffer> file;
+
+  std::function<void()> send_file = [&]() -> void {
+    file = load();
+    peer->write(file, [](SocketWriteEvent& event, Resource& handle) -> void {});
+  };
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    peer = TCPSocket::create(basic_params);
+    peer->init();
+    server.accept(peer);
+    begin = std::chrono::steady_clock::now();
+    send_file();
+  });
+  client->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+    received += event.buffer()->remaining();
+    if (received < kFileSize) {
+      return ;
+    }
+    received = 0;
+    if (++round < kRounds) {
+      send_file();
+      return ;
+    }
+    end = std::chrono::steady_clock::now();
+    client->close();
+    peer->close();
+    server->close();
+    basic_params.loop->uninit();
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    client->read(createFixedSizeBuffer(262144));
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    uv_ip4_addr("127.0.0.1", port, bind_param->getSockAddr());
+    server->bind(bind_param);
+    server->listen(10);
+  });
+  client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+    uv_ip4_addr("127.0.0.1", port, connect_param->getSockAddr());
+    client->connect(connect_param);
+  });
+
+  uv_run(basic_params.loop->get(), UV_RUN_DEFAULT);
+
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (double) kRounds;
+}
+
+int main() {
+  {
+    std::vector<char> content(kFileSize, 'x');
+    FILE* fp = fopen(kFilePath, "wb");
+    fwrite(content.data(), 1, content.size(), fp);
+    fclose(fp);
+  }
+
+  // warm up the page cache
+  readFile();
+
+  bench::report("serve 64MiB: read into heap buffer", serve(45601, readFile));
+  bench::report("serve 64MiB: mmap", serve(45602, mapFile));
+
+  std::remove(kFilePath);
+  return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file	stream_sink_bench.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <memory>
+
+#include <jcu-unio/handle.h>
+#include <jcu-unio/net/socket.h>
+#include <jcu-unio/net/stream_sink.h>
+
+#include "bench_utils.h"
+
+using namespace ::jcu::unio;
+
+static const size_t kReads = 10000000;
+static const size_t kReadSize = 64;
+
+class BenchHandle : public Handle {
+ protected:
+  std::shared_ptr<Resource> sharedAsResource() override {
+    return nullptr;
+  }
+
+  void _init() override {}
+
+ public:
+  void close() override {}
+
+  template <typename U>
+  int emitEvent(U& event) {
+    return emit(event);
+  }
+};
+
+class CountSink : public StreamSink {
+ public:
+  size_t total = 0;
+
+  void onRead(Buffer& buffer) override {
+    total += buffer.remaining();
+    buffer.position(buffer.position() + buffer.remaining());
+  }
+};
+
+/**
+ * The delivery of TCPSocket's readCallback: event with the shared buffer, emit, retain check
+ */
+static double emitterPath() {
+  BenchHandle handle;
+  size_t total = 0;
+  handle.on<CloseEvent>([](CloseEvent& event, Resource& handle) -> void {});
+  handle.on<SocketWriteEvent>([](SocketWriteEvent& event, Resource& handle) -> void {});
+  handle.on<SocketEndEvent>([](SocketEndEvent& event, Resource& handle) -> void {});
+  handle.on<SocketReadEvent>([&total](SocketReadEvent& event, Resource& handle) -> void {
+    auto* buffer = event.buffer();
+    total += buffer->remaining();
+    buffer->position(buffer->position() + buffer->remaining());
+  });
+  std::shared_ptr<Buffer> read_buffer = createFixedSizeBuffer(4096);
+  double ns = bench::measure(kReads, [&](size_t i) -> void {
+    read_buffer->limit(read_buffer->position() + kReadSize);
+    auto buffer = read_buffer;
+    SocketReadEvent event { buffer };
+    handle.emitEvent(event);
+    if (!event.isRetained()) {
+      buffer->clear();
+    }
+  });
+  bench::doNotOptimize(total);
+  return ns;
+}
+
+/**
+ * The delivery to a bound StreamSink, holding the read buffer like readCallback
+ */
+static double sinkPath() {
+  std::shared_ptr<StreamSink> sink_holder = std::make_shared<CountSink>();
+  StreamSink* sink = sink_holder.get();
+  std::shared_ptr<Buffer> read_buffer = createFixedSizeBuffer(4096);
+  double ns = bench::measure(kReads, [&](size_t i) -> void {
+    bench::doNotOptimize(sink);
+    std::shared_ptr<Buffer> buffer(read_buffer);
+    buffer->limit(buffer->position() + kReadSize);
+    sink->onRead(*buffer);
+    buffer->clear();
+  });
+  bench::doNotOptimize(static_cast<CountSink*>(sink)->total);
+  return ns;
+}
+
+int main() {
+  bench::report("read delivery: emit SocketReadEvent", emitterPath());
+  bench::report("read delivery: StreamSink::onRead", sinkPath());
+  return 0;
+}
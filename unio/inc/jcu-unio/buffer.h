@@ -11,8 +11,11 @@
 #define JCU_UNIO_BUFFER_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <memory>
+#include <typeinfo>
+#include <vector>
 
 namespace jcu {
 namespace unio {
@@ -53,10 +56,262 @@ class Buffer {
    * @param size
    */
   virtual void expand(size_t size) = 0;
+
+  /**
+   * Pre-allocate storage so that expand() up to size does not reallocate.
+   * capacity() is not changed.
+   *
+   * @param size
+   */
+  virtual void reserve(size_t /* size */) {}
+};
+
+/**
+ * Ring buffer whose storage is mapped twice back to back,
+ * so both the readable and the writable region are always contiguous.
+ *
+ * - readable: data() ~ data() + remaining() (position() ~ limit())
+ * - writable: writableData() ~ writableData() + writable()
+ * - consume: position(position() + size)
+ * - produce: commit(size)
+ *
+ * flip() does nothing and the buffer can not be expanded.
+ */
+class RingBuffer : public Buffer {
+ public:
+  virtual void* writableData() = 0;
+  virtual size_t writable() const = 0;
+  virtual void commit(size_t size) = 0;
+};
+
+struct BufferOptions {
+  /**
+   * If false, the storage is left uninitialized
+   * and grows geometrically with realloc when expanded.
+   */
+  bool zero_fill = true;
+
+  /**
+   * Alignment of base() in bytes (e.g. 64 for cache lines, 4096 for pages).
+   * Must be a power of two. 0 uses the default of malloc.
+   */
+  size_t alignment = 0;
+
+  /**
+   * Back storage of kHugePageSize or more with huge pages:
+   * MAP_HUGETLB if the system has reserved huge pages, otherwise transparent huge pages (MADV_HUGEPAGE).
+   * Ignored on platforms other than linux.
+   */
+  bool huge_pages = false;
+};
+
+/**
+ * Heap buffer returned by createFixedSizeBuffer() / createExpandableBuffer().
+ *
+ * It is final and its accessors are inline,
+ * so calls through a FlatBuffer pointer are not virtual.
+ * Hot paths detect it with FlatBuffer::from() and use it through visitBuffer().
+ */
+class FlatBuffer final : public Buffer {
+ protected:
+  char* buf_;
+  size_t storage_size_;
+  size_t capacity_;
+  size_t expandable_size_;
+  size_t position_;
+  size_t limit_;
+  BufferOptions options_;
+  /**
+   * buf_ is allocated with mmap
+   */
+  bool mapped_;
+
+  bool resizeStorage(size_t size);
+  size_t roundStorageSize(size_t size) const;
+
+ public:
+  static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+  FlatBuffer(size_t initial_size, size_t expandable_size, const BufferOptions& options);
+  ~FlatBuffer() override;
+
+  FlatBuffer(const FlatBuffer&) = delete;
+  FlatBuffer& operator=(const FlatBuffer&) = delete;
+
+  /**
+   * @return buffer if its dynamic type is FlatBuffer, otherwise nullptr
+   */
+  static FlatBuffer* from(Buffer* buffer) {
+    return (buffer && (typeid(*buffer) == typeid(FlatBuffer))) ? static_cast<FlatBuffer*>(buffer) : nullptr;
+  }
+
+  void *base() override {
+    return buf_;
+  }
+
+  const void *base() const override {
+    return buf_;
+  }
+
+  void *data() override {
+    return buf_ + position_;
+  }
+
+  const void *data() const override {
+    return buf_ + position_;
+  }
+
+  size_t capacity() const override {
+    return capacity_;
+  }
+
+  size_t position() const override {
+    return position_;
+  }
+
+  void position(size_t size) override {
+    position_ = size;
+  }
+
+  void limit(size_t size) override {
+    limit_ = size;
+  }
+
+  size_t remaining() const override {
+    return limit_ - position_;
+  }
+
+  void flip() override {
+    limit_ = position_;
+    position_ = 0;
+  }
+
+  void clear() override {
+    position_ = 0;
+    limit_ = capacity_;
+  }
+
+  size_t getExpandableSize() const override {
+    return expandable_size_;
+  }
+
+  void expand(size_t size) override;
+  void reserve(size_t size) override;
+
+  /**
+   * @return bytes allocated for the storage, capacity() or more
+   */
+  size_t getStorageSize() const {
+    return storage_size_;
+  }
+
+  /**
+   * @return getStorageSize() after expand(size)
+   */
+  size_t getStorageSizeForExpand(size_t size) const;
+
+  /**
+   * @return getStorageSize() after reserve(size)
+   */
+  size_t getStorageSizeForReserve(size_t size) const;
+};
+
+/**
+ * Call fn with FlatBuffer* if buffer is a FlatBuffer, otherwise with Buffer*.
+ * fn is usually a generic lambda, so it is instantiated for both.
+ */
+template <typename F>
+inline auto visitBuffer(Buffer* buffer, F&& fn) -> decltype(fn(buffer)) {
+  FlatBuffer* flat_buffer = FlatBuffer::from(buffer);
+  if (flat_buffer) {
+    return fn(flat_buffer);
+  }
+  return fn(buffer);
+}
+
+/**
+ * Buffers written or read together (scatter-gather)
+ */
+typedef std::vector<std::shared_ptr<Buffer>> BufferChain;
+
+/**
+ * Read-only view of a range of a Buffer.
+ * It keeps the Buffer alive, so it can be retained without copying.
+ */
+class BufferSlice {
+ protected:
+  std::shared_ptr<Buffer> owner_;
+  const char* data_;
+  size_t size_;
+
+ public:
+  BufferSlice() :
+      data_(nullptr), size_(0) {}
+
+  BufferSlice(std::shared_ptr<Buffer> owner, const void* data, size_t size) :
+      owner_(std::move(owner)), data_((const char*) data), size_(size) {}
+
+  /**
+   * slice of the remaining data of the buffer
+   */
+  explicit BufferSlice(std::shared_ptr<Buffer> owner) :
+      data_(owner ? (const char*) owner->data() : nullptr),
+      size_(owner ? owner->remaining() : 0)
+  {
+    owner_ = std::move(owner);
+  }
+
+  const void* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  const std::shared_ptr<Buffer>& owner() const {
+    return owner_;
+  }
+
+  BufferSlice slice(size_t offset, size_t size) const {
+    if (offset > size_) offset = size_;
+    if (size > size_ - offset) size = size_ - offset;
+    return BufferSlice(owner_, data_ + offset, size);
+  }
+
+  /**
+   * Buffer view of the slice (e.g. to write it to another socket).
+   * It must not be modified.
+   */
+  std::shared_ptr<Buffer> asBuffer() const;
 };
 
 std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size);
+std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size, const BufferOptions& options);
 std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size);
+std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size, const BufferOptions& options);
+
+/**
+ * @param size rounded up to the page size
+ * @return nullptr if it fails or the platform does not support it (linux only)
+ */
+std::shared_ptr<RingBuffer> createRingBuffer(size_t size);
+
+/**
+ * Read-only buffer backed by mmap of a file region, for writing static content
+ * to a socket without copying it into the heap.
+ * It is ready to be written: position() is 0 and limit() is the length.
+ *
+ * @param path   file path
+ * @param offset file offset
+ * @param length length of the region, 0 for the rest of the file
+ * @return nullptr if it fails or the platform does not support it
+ */
+std::shared_ptr<Buffer> createMappedFileBuffer(const char* path, uint64_t offset = 0, size_t length = 0);
 
 } // namespace unio
 } // namespace jcu
@@ -0,0 +1,86 @@
+/**
+ * @file	buffer_budget.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_BUFFER_BUDGET_H_
+#define JCU_UNIO_BUFFER_BUDGET_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "unique_function.h"
+
+namespace jcu {
+namespace unio {
+
+enum BufferCategory {
+  kBufferOther = 0,
+  /**
+   * socket read buffers
+   */
+  kBufferRead,
+  /**
+   * buffers created to be written
+   */
+  kBufferWrite,
+  /**
+   * SSLSocket record buffers
+   */
+  kBufferTls,
+  kBufferCategoryCount
+};
+
+/**
+ * Memory budget of IO buffers.
+ *
+ * Set it to BasicParams::buffer_budget, for one Loop or shared by several Loops.
+ * Buffers created with BasicParams account their capacity to it until they are released,
+ * and the factories return nullptr if the limit would be exceeded.
+ *
+ * When the usage reaches the pressure threshold,
+ * sockets stop reading (SocketPressureEvent) until it drops below the threshold again.
+ *
+ * It is thread-safe.
+ */
+class BufferBudget {
+ public:
+  virtual ~BufferBudget() = default;
+
+  /**
+   * @param limit maximum bytes, the pressure threshold is 90% of it
+   */
+  static std::shared_ptr<BufferBudget> create(size_t limit);
+  static std::shared_ptr<BufferBudget> create(size_t limit, size_t pressure_threshold);
+
+  virtual size_t getLimit() const = 0;
+  virtual size_t getPressureThreshold() const = 0;
+
+  virtual size_t getUsage(BufferCategory category) const = 0;
+  virtual size_t getTotalUsage() const = 0;
+
+  virtual bool isUnderPressure() const = 0;
+
+  /**
+   * @return false if it would exceed the limit (nothing is accounted)
+   */
+  virtual bool acquire(BufferCategory category, size_t bytes) = 0;
+  virtual void release(BufferCategory category, size_t bytes) = 0;
+
+  /**
+   * Call fn once when the usage drops below the pressure threshold.
+   * fn is called immediately if it is not under pressure,
+   * otherwise on the thread releasing the buffer.
+   */
+  virtual void waitForRelief(UniqueFunction<void()> fn) = 0;
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_BUFFER_BUDGET_H_
@@ -0,0 +1,90 @@
+/**
+ * @file	buffer_pool.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_BUFFER_POOL_H_
+#define JCU_UNIO_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "buffer.h"
+#include "buffer_budget.h"
+#include "resource.h"
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Size-class slab pool for IO buffers.
+ *
+ * Each size class carves its blocks out of slabs.
+ * A block goes back to its class when the last reference to the Buffer is released.
+ * Requests larger than the largest class are served from the heap.
+ * Slabs are kept while the pool lives, even when all their blocks are free,
+ * so the pool only grows until trim() is called.
+ *
+ * It is thread-safe.
+ */
+class BufferPool {
+ public:
+  virtual ~BufferPool() = default;
+
+  /**
+   * Create a pool with the default size classes (4K, 16K, 64K)
+   */
+  static std::shared_ptr<BufferPool> create();
+
+  /**
+   * @param size_classes block sizes of each class
+   * @param slab_size    bytes allocated at once when a class runs out of blocks
+   */
+  static std::shared_ptr<BufferPool> create(const std::vector<size_t>& size_classes, size_t slab_size);
+
+  virtual std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size) = 0;
+  virtual std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size) = 0;
+
+  /**
+   * Free the slabs none of whose blocks are in use, e.g. after a burst of connections
+   *
+   * @return bytes freed
+   */
+  virtual size_t trim() = 0;
+};
+
+/**
+ * Use basic_params.buffer_pool if set, otherwise same as createFixedSizeBuffer(size).
+ * The capacity is accounted to basic_params.buffer_budget as category if it is set.
+ *
+ * @return nullptr if it exceeds the limit of basic_params.buffer_budget
+ */
+std::shared_ptr<Buffer> createFixedSizeBuffer(const BasicParams& basic_params, size_t size, BufferCategory category = kBufferOther);
+
+/**
+ * Use basic_params.buffer_pool if set, otherwise same as createExpandableBuffer(initial_size, expandable_size).
+ * The capacity is accounted to basic_params.buffer_budget as category if it is set,
+ * and expand() does nothing if it would exceed the limit.
+ *
+ * @return nullptr if it exceeds the limit of basic_params.buffer_budget
+ */
+std::shared_ptr<Buffer> createExpandableBuffer(const BasicParams& basic_params, size_t initial_size, size_t expandable_size, BufferCategory category = kBufferOther);
+
+/**
+ * Same as createRingBuffer(size).
+ * The size is accounted to basic_params.buffer_budget as category if it is set.
+ *
+ * @return nullptr if it fails or exceeds the limit of basic_params.buffer_budget
+ */
+std::shared_ptr<RingBuffer> createRingBuffer(const BasicParams& basic_params, size_t size, BufferCategory category = kBufferOther);
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_BUFFER_POOL_H_
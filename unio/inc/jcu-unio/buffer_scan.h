@@ -0,0 +1,96 @@
+/**
+ * @file	buffer_scan.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_BUFFER_SCAN_H_
+#define JCU_UNIO_BUFFER_SCAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Byte scanning for protocol parsers.
+ *
+ * SSE2 or AVX2 is selected at runtime by the CPU, with a scalar fallback.
+ * The Buffer overloads scan the remaining data (data() ~ data() + remaining())
+ * and return offsets relative to data().
+ */
+
+/**
+ * returned by the find functions if there is no match
+ */
+static const size_t kScanNotFound = (size_t) -1;
+
+/**
+ * @return offset of the first value, or kScanNotFound
+ */
+size_t findByte(const void* data, size_t size, uint8_t value);
+
+/**
+ * @param set      bytes to find
+ * @param set_size number of bytes in set (up to 16 are vectorized)
+ * @return offset of the first byte that is in set, or kScanNotFound
+ */
+size_t findAnyOf(const void* data, size_t size, const void* set, size_t set_size);
+
+/**
+ * @return offset of the first "\r\n\r\n", or kScanNotFound
+ */
+size_t findCrlfCrlf(const void* data, size_t size);
+
+/**
+ * @return number of '\n'
+ */
+size_t countNewlines(const void* data, size_t size);
+
+/**
+ * @return name of the selected implementation ("avx2", "sse2" or "scalar")
+ */
+const char* getScanImplementation();
+
+inline size_t findByte(const Buffer& buffer, uint8_t value) {
+  return findByte(buffer.data(), buffer.remaining(), value);
+}
+
+inline size_t findAnyOf(const Buffer& buffer, const void* set, size_t set_size) {
+  return findAnyOf(buffer.data(), buffer.remaining(), set, set_size);
+}
+
+inline size_t findCrlfCrlf(const Buffer& buffer) {
+  return findCrlfCrlf(buffer.data(), buffer.remaining());
+}
+
+inline size_t countNewlines(const Buffer& buffer) {
+  return countNewlines(buffer.data(), buffer.remaining());
+}
+
+inline size_t findByte(const BufferSlice& slice, uint8_t value) {
+  return findByte(slice.data(), slice.size(), value);
+}
+
+inline size_t findAnyOf(const BufferSlice& slice, const void* set, size_t set_size) {
+  return findAnyOf(slice.data(), slice.size(), set, set_size);
+}
+
+inline size_t findCrlfCrlf(const BufferSlice& slice) {
+  return findCrlfCrlf(slice.data(), slice.size());
+}
+
+inline size_t countNewlines(const BufferSlice& slice) {
+  return countNewlines(slice.data(), slice.size());
+}
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_BUFFER_SCAN_H_
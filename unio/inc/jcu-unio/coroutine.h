@@ -0,0 +1,262 @@
+/**
+ * @file	coroutine.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_COROUTINE_H_
+#define JCU_UNIO_COROUTINE_H_
+
+#include <stddef.h>
+
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define JCU_UNIO_HAS_COROUTINE 1
+#endif
+#endif
+
+#if defined(JCU_UNIO_HAS_COROUTINE)
+#include <coroutine>
+#include <optional>
+#endif
+
+#include "loop.h"
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Coroutine frames are recycled by the thread that frees them (up to 1KiB frames).
+ * On a loop thread, it is effectively a pool of the loop.
+ */
+void* allocateCoroutineFrame(size_t size);
+void freeCoroutineFrame(void* ptr, size_t size);
+
+#if defined(JCU_UNIO_HAS_COROUTINE)
+
+template<typename T>
+class Task;
+
+namespace detail {
+
+class TaskPromiseBase {
+ public:
+  static void* operator new(size_t size) {
+    return allocateCoroutineFrame(size);
+  }
+
+  static void operator delete(void* ptr, size_t size) {
+    freeCoroutineFrame(ptr, size);
+  }
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    template<typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+      TaskPromiseBase& promise = handle.promise();
+      if (promise.detached_) {
+        handle.destroy();
+        return std::noop_coroutine();
+      }
+      if (!promise.continuation_) {
+        return std::noop_coroutine();
+      }
+      std::shared_ptr<Loop> loop = std::move(promise.continuation_loop_);
+      if (loop && !loop->isInLoopThread()) {
+        // the awaiting coroutine may destroy this frame as soon as it is posted
+        std::coroutine_handle<> continuation = promise.continuation_;
+        loop->post([continuation]() -> void {
+          continuation.resume();
+        });
+        return std::noop_coroutine();
+      }
+      return promise.continuation_;
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept {
+    return {};
+  }
+
+  FinalAwaiter final_suspend() const noexcept {
+    return {};
+  }
+
+  void unhandled_exception() noexcept {
+    if (detached_) {
+      // nobody can receive it, like std::thread
+      std::terminate();
+    }
+    exception_ = std::current_exception();
+  }
+
+  /**
+   * The awaiting coroutine is resumed on the loop it was running on
+   */
+  void setContinuation(std::coroutine_handle<> continuation) {
+    continuation_ = continuation;
+    const Loop* current = Loop::getCurrent();
+    if (current) {
+      continuation_loop_ = current->shared();
+    }
+  }
+
+  void setDetached() {
+    detached_ = true;
+  }
+
+  void rethrowIfFailed() {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+ private:
+  std::coroutine_handle<> continuation_;
+  std::shared_ptr<Loop> continuation_loop_;
+  std::exception_ptr exception_;
+  bool detached_ = false;
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  template<typename U>
+  void return_value(U&& value) {
+    result_.emplace(std::forward<U>(value));
+  }
+
+  T takeResult() {
+    rethrowIfFailed();
+    return std::move(*result_);
+  }
+
+ private:
+  std::optional<T> result_;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  void return_void() {}
+
+  void takeResult() {
+    rethrowIfFailed();
+  }
+};
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine.
+ *
+ * `co_await task` starts it, and the awaiting coroutine is resumed with the result
+ * on the loop thread it was running on (directly, if the task completes on the same thread).
+ * `detach()` starts it without waiting, and the frame is freed when it completes.
+ *
+ * @code
+ * Task<int> handle(std::shared_ptr<Loop> loop) {
+ *   co_await loop->schedule();
+ *   co_return 1;
+ * }
+ * @endcode
+ */
+template<typename T = void>
+class Task {
+ public:
+  class promise_type : public detail::TaskPromise<T> {
+   public:
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+  };
+
+  Task() = default;
+
+  Task(Task&& other) noexcept :
+      handle_(std::exchange(other.handle_, nullptr))
+  {}
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      reset();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() {
+    reset();
+  }
+
+  bool valid() const {
+    return (bool) handle_;
+  }
+
+  /**
+   * Start it on the calling thread without waiting
+   */
+  void detach() {
+    std::coroutine_handle<promise_type> handle = std::exchange(handle_, nullptr);
+    if (handle) {
+      handle.promise().setDetached();
+      handle.resume();
+    }
+  }
+
+  /**
+   * @throws std::logic_error if it is empty (default constructed, moved from or detached)
+   */
+  bool await_ready() const {
+    if (!handle_) {
+      throw std::logic_error("jcu::unio::Task: awaiting an empty task");
+    }
+    return handle_.done();
+  }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+    handle_.promise().setContinuation(awaiting);
+    return handle_;
+  }
+
+  T await_resume() {
+    return handle_.promise().takeResult();
+  }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) :
+      handle_(handle)
+  {}
+
+  void reset() {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+};
+
+#endif // JCU_UNIO_HAS_COROUTINE
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_COROUTINE_H_
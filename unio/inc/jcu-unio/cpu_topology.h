@@ -0,0 +1,83 @@
+/**
+ * @file	cpu_topology.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_CPU_TOPOLOGY_H_
+#define JCU_UNIO_CPU_TOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Online CPUs and their NUMA nodes.
+ * On the platforms other than linux, every CPU is on node 0.
+ */
+struct CpuTopology {
+  std::vector<int> cpus;
+  /**
+   * NUMA node of cpus[i]
+   */
+  std::vector<int> cpu_nodes;
+  /**
+   * NUMA nodes having online CPUs
+   */
+  std::vector<int> nodes;
+
+  static CpuTopology detect();
+
+  /**
+   * @return -1 if it is not an online CPU
+   */
+  int getNumaNode(int cpu) const;
+  std::vector<int> getNodeCpus(int node) const;
+};
+
+enum NumaMemoryPolicy {
+  kNumaMemoryDefault = 0,
+  /**
+   * allocate from the local node, falls back to the other nodes if it is full
+   */
+  kNumaMemoryPreferLocal,
+  /**
+   * allocate only from the local node
+   */
+  kNumaMemoryBindLocal,
+};
+
+/**
+ * @return CPU the calling thread is running on, -1 if it is not supported
+ */
+int getCurrentCpu();
+
+/**
+ * Pin the calling thread to the CPUs.
+ *
+ * @return 0 or UV_xxx error code (UV_ENOTSUP if it is not supported)
+ */
+int setThreadAffinity(const std::vector<int>& cpus);
+
+/**
+ * Set the memory policy of the calling thread.
+ * It applies to the pages the thread touches first, e.g. buffers and handles created on a loop thread.
+ *
+ * @return 0 or UV_xxx error code (UV_ENOTSUP if it is not supported)
+ */
+int setThreadNumaMemory(int node, NumaMemoryPolicy policy);
+
+/**
+ * @return "0-3,8" style list
+ */
+std::string formatCpuList(const std::vector<int>& cpus);
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_CPU_TOPOLOGY_H_
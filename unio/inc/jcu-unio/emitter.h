@@ -11,20 +11,67 @@
 #ifndef JCU_UNIO_EMITTER_H_
 #define JCU_UNIO_EMITTER_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <functional>
 #include <type_traits>
-#include <unordered_map>
-#include <list>
 #include <mutex>
+#include <vector>
 
 #include "event.h"
+#include "small_vector.h"
 
 namespace jcu {
 namespace unio {
 
 class Resource;
 
+/**
+ * @return a new event type id, they are dense from 0
+ */
+size_t allocateEventTypeId();
+
+/**
+ * Id of the event type, assigned once on first use
+ */
+template <typename U>
+struct EventTypeId {
+  static size_t get() {
+    static const size_t id = allocateEventTypeId();
+    return id;
+  }
+};
+
+/**
+ * One listener added by Emitter::on/once, for Emitter::off(token)
+ */
+class ListenerToken {
+ public:
+  ListenerToken() :
+      type_id_(SIZE_MAX), index_(0), generation_(0)
+  {}
+
+  /**
+   * @return false for an empty token, e.g. an InitEvent listener called at once.
+   *         It is still true after the listener is removed.
+   */
+  bool valid() const {
+    return type_id_ != SIZE_MAX;
+  }
+
+ private:
+  friend class Emitter;
+
+  size_t type_id_;
+  uint32_t index_;
+  uint32_t generation_;
+
+  ListenerToken(size_t type_id, uint32_t index, uint32_t generation) :
+      type_id_(type_id), index_(index), generation_(generation)
+  {}
+};
+
 /**
  * event emitter
  */
@@ -35,6 +82,10 @@ class Emitter {
  protected:
   bool inited_;
   InitEvent init_event_;
+  /**
+   * this as Resource, set by Handle so that emit does not need dynamic_cast
+   */
+  Resource* resource_;
 
   virtual std::mutex& getInitMutex() = 0;
 
@@ -51,45 +102,220 @@ class Emitter {
     virtual ~BaseHandler() = default;
     virtual void clear() = 0;
     virtual int size() const = 0;
+    virtual bool remove(uint32_t index, uint32_t generation) = 0;
   };
 
+  struct ListenerSlot {
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  /**
+   * Listeners are slots of an array, linked in the order they are added.
+   * A removed slot is reused by the next listener, and its generation is increased
+   * so that the tokens of the removed listener do not match it.
+   *
+   * Listeners can be added and removed (also off/offAll) while they are called.
+   * The ones added during a call are called from the next emit.
+   */
   template <typename U>
   class Handler : public BaseHandler {
    private:
+    static const uint32_t kNone = UINT32_MAX;
+
     struct Listener {
-      bool once;
       std::function<void(U& event, Resource& handle)> func;
+      uint32_t generation;
+      uint32_t prev;
+      /**
+       * next in the call order, or in the free list
+       */
+      uint32_t next;
+      bool once;
+      bool removed;
     };
-    std::list<Listener> callbacks_;
+    /**
+     * most handles have one or two listeners per event type
+     */
+    SmallVector<Listener, 2> listeners_;
+    /**
+     * added during a call, appended to listeners_ when the outermost call returns.
+     * The array must not grow while a listener in it is running.
+     */
+    std::vector<Listener> added_;
+    uint32_t head_ = kNone;
+    uint32_t tail_ = kNone;
+    uint32_t free_ = kNone;
+    int live_ = 0;
+    int calling_ = 0;
+    bool has_removed_ = false;
+
+    void link(uint32_t index) {
+      Listener& listener = listeners_[index];
+      listener.prev = tail_;
+      listener.next = kNone;
+      if (tail_ != kNone) {
+        listeners_[tail_].next = index;
+      } else {
+        head_ = index;
+      }
+      tail_ = index;
+    }
+
+    void release(uint32_t index) {
+      Listener& listener = listeners_[index];
+      if (listener.prev != kNone) {
+        listeners_[listener.prev].next = listener.next;
+      } else {
+        head_ = listener.next;
+      }
+      if (listener.next != kNone) {
+        listeners_[listener.next].prev = listener.prev;
+      } else {
+        tail_ = listener.prev;
+      }
+      listener.func = nullptr;
+      listener.removed = true;
+      listener.generation++;
+      listener.prev = kNone;
+      listener.next = free_;
+      free_ = index;
+    }
+
+    ListenerSlot add(bool once, std::function<void(U& event, Resource& handle)>&& callback) {
+      live_++;
+      if (calling_) {
+        // its index after flush()
+        uint32_t index = (uint32_t) (listeners_.size() + added_.size());
+        added_.emplace_back(Listener {std::move(callback), 0, kNone, kNone, once, false});
+        return ListenerSlot {index, 0};
+      }
+      uint32_t index = free_;
+      if (index != kNone) {
+        Listener& listener = listeners_[index];
+        free_ = listener.next;
+        listener.func = std::move(callback);
+        listener.once = once;
+        listener.removed = false;
+      } else {
+        index = (uint32_t) listeners_.size();
+        listeners_.emplace_back(Listener {std::move(callback), 0, kNone, kNone, once, false});
+      }
+      link(index);
+      return ListenerSlot {index, listeners_[index].generation};
+    }
+
+    void flush() {
+      for (auto& listener : added_) {
+        uint32_t index = (uint32_t) listeners_.size();
+        listeners_.emplace_back(std::move(listener));
+        link(index);
+      }
+      added_.clear();
+      if (has_removed_) {
+        has_removed_ = false;
+        for (uint32_t index = head_; index != kNone; ) {
+          uint32_t next = listeners_[index].next;
+          if (listeners_[index].removed) {
+            release(index);
+          }
+          index = next;
+        }
+      }
+    }
 
    public:
     void clear() override {
-      callbacks_.clear();
+      live_ = 0;
+      if (calling_) {
+        // the running listener must not be destroyed
+        for (uint32_t index = head_; index != kNone; index = listeners_[index].next) {
+          listeners_[index].removed = true;
+        }
+        for (auto& listener : added_) {
+          listener.removed = true;
+        }
+        has_removed_ = true;
+        return ;
+      }
+      // the slots are kept for the generations
+      while (head_ != kNone) {
+        release(head_);
+      }
     }
     int size() const override {
-      return callbacks_.size();
+      return live_;
+    }
+    bool remove(uint32_t index, uint32_t generation) override {
+      Listener* listener;
+      if (index < listeners_.size()) {
+        listener = &listeners_[index];
+      } else if (index - listeners_.size() < added_.size()) {
+        listener = &added_[index - listeners_.size()];
+      } else {
+        return false;
+      }
+      if (listener->removed || (listener->generation != generation)) {
+        return false;
+      }
+      live_--;
+      if (calling_) {
+        listener->removed = true;
+        has_removed_ = true;
+      } else {
+        release(index);
+      }
+      return true;
     }
     int call(U& event, Resource& handle) {
       int count = 0;
-      for (auto it = callbacks_.begin(); it != callbacks_.end(); count++) {
-        it->func(event, handle);
-        if (it->once) {
-          it = callbacks_.erase(it);
-        } else {
-          it++;
+      calling_++;
+      // neither the array nor the links change during the call
+      for (uint32_t index = head_; index != kNone; index = listeners_[index].next) {
+        Listener& listener = listeners_[index];
+        if (listener.removed) {
+          continue;
         }
+        if (listener.once) {
+          listener.removed = true;
+          has_removed_ = true;
+          live_--;
+        }
+        listener.func(event, handle);
+        count++;
+      }
+      if (--calling_ == 0) {
+        flush();
       }
       return count;
     }
-    void on(std::function<void(U& event, Resource& handle)> callback) {
-      callbacks_.emplace_back(std::move(Listener {false, std::move(callback)}));
+    ListenerSlot on(std::function<void(U& event, Resource& handle)> callback) {
+      return add(false, std::move(callback));
     }
-    void once(std::function<void(U& event, Resource& handle)> callback) {
-      callbacks_.emplace_back(std::move(Listener {true, std::move(callback)}));
+    ListenerSlot once(std::function<void(U& event, Resource& handle)> callback) {
+      return add(true, std::move(callback));
     }
   };
 
-  std::unordered_map<size_t, std::unique_ptr<BaseHandler>> handlers_ {};
+  /**
+   * indexed by EventTypeId
+   */
+  std::vector<std::unique_ptr<BaseHandler>> handlers_ {};
+
+  template <class U>
+  static size_t getEventTypeId() {
+    return EventTypeId<typename std::remove_cv<U>::type>::get();
+  }
+
+  template <class U>
+  Handler<U>* findHandler() const {
+    size_t id = getEventTypeId<U>();
+    if (id < handlers_.size()) {
+      // the id is unique to U
+      return static_cast<Handler<U>*>(handlers_[id].get());
+    }
+    return nullptr;
+  }
 
   /**
    * The getInitMutex must be locked.
@@ -104,7 +330,11 @@ class Emitter {
 
   template <class U>
   Handler<U>* getHandler() {
-    auto& p = handlers_[typeid(U).hash_code()];
+    size_t id = getEventTypeId<U>();
+    if (id >= handlers_.size()) {
+      handlers_.resize(id + 1);
+    }
+    auto& p = handlers_[id];
     Handler<U>* q = static_cast<Handler<U>*>(p.get());
     if (!p) {
       q = new Handler<U>();
@@ -114,7 +344,7 @@ class Emitter {
   }
 
  public:
-  Emitter() : inited_(false) {}
+  Emitter() : inited_(false), resource_(nullptr) {}
 
   /**
    * emit event
@@ -122,80 +352,94 @@ class Emitter {
    */
   template <typename U>
   int emit(U& event) {
-    auto it = handlers_.find(typeid(U).hash_code());
-    if (it != handlers_.end()) {
-      Handler<U>* handler = dynamic_cast<Handler<U>*>(it->second.get());
-      if (handler) {
-        return handler->call(event, dynamic_cast<Resource&>(*this));
-      }
+    Handler<U>* handler = findHandler<U>();
+    if (handler) {
+      return handler->call(event, resource_ ? *resource_ : dynamic_cast<Resource&>(*this));
     }
     return 0;
   }
 
+  /**
+   * @return token to remove only this listener
+   */
   template <typename U>
-  void on(std::function<void(U& event, Resource& handle)> callback) {
+  ListenerToken on(std::function<void(U& event, Resource& handle)> callback) {
     auto q = getHandler<U>();
-    q->on(std::move(callback));
+    ListenerSlot slot = q->on(std::move(callback));
+    return ListenerToken(getEventTypeId<U>(), slot.index, slot.generation);
   }
 
+  /**
+   * @return token to remove only this listener
+   */
   template <typename U>
-  void once(std::function<void(U& event, Resource& handle)> callback) {
+  ListenerToken once(std::function<void(U& event, Resource& handle)> callback) {
     auto q = getHandler<U>();
-    q->once(std::move(callback));
+    ListenerSlot slot = q->once(std::move(callback));
+    return ListenerToken(getEventTypeId<U>(), slot.index, slot.generation);
+  }
+
+  /**
+   * Remove the listener of the token in O(1), also while the listeners are called.
+   *
+   * @return false if it is already removed (or called, if it was added by once)
+   */
+  bool off(const ListenerToken& token) {
+    if (token.type_id_ < handlers_.size() && handlers_[token.type_id_]) {
+      return handlers_[token.type_id_]->remove(token.index_, token.generation_);
+    }
+    return false;
   }
 
   template <typename U>
   void off() {
-    auto it = handlers_.find(typeid(U).hash_code());
-    if (it != handlers_.end()) {
-      if (it->second) {
-        it->second->clear();
-      }
-      handlers_.erase(it);
+    size_t id = getEventTypeId<U>();
+    if (id < handlers_.size() && handlers_[id]) {
+      // kept, it may be calling the listeners
+      handlers_[id]->clear();
     }
   }
 
   void offAll() {
-    for (auto it = handlers_.begin(); it != handlers_.end(); ) {
-      if (it->second) {
-        it->second->clear();
+    for (auto& handler : handlers_) {
+      if (handler) {
+        handler->clear();
       }
-      it = handlers_.erase(it);
     }
   }
 
   template <typename U>
   int getEventCount() {
-    auto it = handlers_.find(typeid(U).hash_code());
-    if (it != handlers_.end()) {
-      if (it->second) {
-        return it->second->size();
-      }
+    Handler<U>* handler = findHandler<U>();
+    if (handler) {
+      return handler->size();
     }
     return 0;
   }
 };
 
 template <>
-inline void Emitter::on<InitEvent>(std::function<void(InitEvent& event, Resource& handle)> callback) {
+inline ListenerToken Emitter::on<InitEvent>(std::function<void(InitEvent& event, Resource& handle)> callback) {
   std::unique_lock<std::mutex> lock(getInitMutex());
   if (inited_) {
     invokeInitEventCallback(std::move(callback), init_event_);
-    return ;
+    return ListenerToken();
   }
   auto q = getHandler<InitEvent>();
-  q->on(std::move(callback));
+  ListenerSlot slot = q->on(std::move(callback));
+  return ListenerToken(getEventTypeId<InitEvent>(), slot.index, slot.generation);
 }
 
 template <>
-inline void Emitter::once<InitEvent>(std::function<void(InitEvent& event, Resource& handle)> callback) {
+inline ListenerToken Emitter::once<InitEvent>(std::function<void(InitEvent& event, Resource& handle)> callback) {
   std::unique_lock<std::mutex> lock(getInitMutex());
   if (inited_) {
     invokeInitEventCallback(std::move(callback), init_event_);
-    return ;
+    return ListenerToken();
   }
   auto q = getHandler<InitEvent>();
-  q->once(std::move(callback));
+  ListenerSlot slot = q->once(std::move(callback));
+  return ListenerToken(getEventTypeId<InitEvent>(), slot.index, slot.generation);
 }
 
 } // namespace unio
@@ -15,6 +15,7 @@
 #include <string>
 
 #include "resource.h"
+#include "unique_function.h"
 
 namespace jcu {
 namespace unio {
@@ -82,11 +83,13 @@ class InitEvent : public AbstractEvent {
 };
 
 /**
+ * Move-only, lambdas capturing up to 64 bytes (e.g. a few shared_ptr) are stored without allocation.
+ *
  * @tparam T event type
  * @tparam B base handle type
  */
 template <typename T>
-using CompletionCallback = std::function<void(T& event, Resource& handle)>;
+using CompletionCallback = UniqueFunction<void(T& event, Resource& handle), 64>;
 
 template <typename T>
 using CompletionOnceCallback = CompletionCallback<T>;
@@ -38,6 +38,10 @@ class Handle : public Resource, public Emitter {
 
   virtual void _init() = 0;
  public:
+  Handle() {
+    resource_ = this;
+  }
+
   /**
    * initialize handle
    *
@@ -0,0 +1,120 @@
+/**
+ * @file	histogram.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_HISTOGRAM_H_
+#define JCU_UNIO_HISTOGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace jcu {
+namespace unio {
+
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = 0;
+  uint64_t max = 0;
+  /**
+   * counts of Histogram buckets
+   */
+  std::vector<uint64_t> buckets;
+
+  double mean() const;
+
+  /**
+   * @param percent 0 ~ 100
+   * @return upper bound of the bucket containing the percentile (not more than max)
+   */
+  uint64_t percentile(double percent) const;
+};
+
+/**
+ * HDR-style log-linear histogram: values below 2^kSubBucketBits have a bucket each,
+ * larger ones 8 linear sub-buckets per power of two,
+ * so a recorded value is off by less than 1/8 of it.
+ * Values above kMaxValue are counted as kMaxValue.
+ *
+ * record() must be called from one thread at a time (e.g. the loop thread),
+ * and snapshot() can be called from any thread.
+ */
+class Histogram {
+ public:
+  static const int kSubBucketBits = 4;
+  static const uint64_t kMaxValue = (1ULL << 42) - 1;
+  static const size_t kBucketCount = 320;
+
+  Histogram();
+
+  static size_t getBucketIndex(uint64_t value) {
+    if (value > kMaxValue) {
+      value = kMaxValue;
+    }
+    if (value < (1ULL << kSubBucketBits)) {
+      return (size_t) value;
+    }
+    int shift = 63 - clz(value) - (kSubBucketBits - 1);
+    return (size_t) shift * (1U << (kSubBucketBits - 1)) + (size_t) (value >> shift);
+  }
+
+  /**
+   * @return lowest value of the bucket
+   */
+  static uint64_t getBucketValue(size_t index);
+
+  void record(uint64_t value) {
+    size_t index = getBucketIndex(value);
+    // single writer: no read-modify-write instruction is needed
+    buckets_[index].store(buckets_[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value < min_.load(std::memory_order_relaxed)) {
+      min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  HistogramSnapshot snapshot() const;
+
+  /**
+   * Same thread requirement as record()
+   */
+  void reset();
+
+ private:
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+  std::atomic<uint64_t> buckets_[kBucketCount];
+
+  static int clz(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (int) index;
+#else
+    return __builtin_clzll(value);
+#endif
+  }
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_HISTOGRAM_H_
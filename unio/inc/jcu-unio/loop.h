@@ -10,19 +10,115 @@
 #ifndef JCU_UNIO_LOOP_H_
 #define JCU_UNIO_LOOP_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <functional>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #include <uv.h>
 
+#include "histogram.h"
 #include "shared_object.h"
+#include "unique_function.h"
+#include "work_pool.h"
 
 namespace jcu {
 namespace unio {
 
-typedef std::function<void()> QueuedTask_t;
+/**
+ * Lambdas capturing up to 96 bytes are queued without allocation
+ */
+typedef UniqueFunction<void(), 96> QueuedTask_t;
+
+/**
+ * Called with a uv error code instead of the completion of Loop::submitWork
+ */
+typedef UniqueFunction<void(int status), 96> WorkErrorTask_t;
+
+/**
+ * Lanes of the queued tasks.
+ */
+enum TaskPriority {
+  /**
+   * run before the normal tasks, e.g. resuming a stalled socket
+   */
+  kTaskPriorityHigh = 0,
+  kTaskPriorityNormal,
+  /**
+   * run in small batches only while the other lanes are empty,
+   * the loop keeps polling I/O between the batches
+   */
+  kTaskPriorityIdle,
+  kTaskPriorityCount
+};
+
+/**
+ * Limit of the queued tasks run per loop iteration.
+ * The rest is run in the next iteration, after the loop has polled I/O.
+ */
+struct QueuedTaskBudget {
+  /**
+   * 0 for unlimited
+   */
+  size_t max_tasks = 1024;
+  /**
+   * nanoseconds, 0 for unlimited
+   */
+  uint64_t max_time = 0;
+};
+
+struct QueuedTaskStats {
+  /**
+   * loop iterations that ran queued tasks
+   */
+  uint64_t iterations = 0;
+  uint64_t tasks_run = 0;
+  /**
+   * tasks run in the last iteration
+   */
+  uint64_t last_tasks_run = 0;
+  uint64_t max_tasks_run = 0;
+  /**
+   * iterations that ran out of the budget
+   */
+  uint64_t deferred_iterations = 0;
+  /**
+   * sum of the tasks left for the next iteration
+   */
+  uint64_t deferred_tasks = 0;
+};
+
+/**
+ * All times are in nanoseconds.
+ */
+struct LoopMetricsSnapshot {
+  /**
+   * iterations measured since the metrics are enabled (or reset)
+   */
+  uint64_t iterations = 0;
+  /**
+   * from one iteration to the next one
+   */
+  HistogramSnapshot iteration_time;
+  /**
+   * time waiting for I/O in each iteration
+   */
+  HistogramSnapshot idle_time;
+  /**
+   * time running callbacks in each iteration (iteration_time - idle_time)
+   */
+  HistogramSnapshot busy_time;
+  /**
+   * from sendQueuedTask to the task is run, sampled (1 of 8 tasks)
+   */
+  HistogramSnapshot queued_task_wait;
+};
 
 struct LoopContext;
+struct LoopScheduleAwaiter;
 class Loop : public SharedObject<Loop> {
  protected:
   std::unique_ptr<LoopContext> ctx_;
@@ -46,13 +142,174 @@ class Loop : public SharedObject<Loop> {
    */
   void uninit();
 
+  /**
+   * Close every handle left on the loop, uninit() first if it was not.
+   * The handles of Timer and Socket are closed by their close(), so CloseEvent is emitted.
+   *
+   * It must be called from a loop thread.
+   * Handles initialized directly with uv_xxx_init must be closed before it.
+   */
+  void closeHandles();
+
   /**
    * The uv_xxx_init function is not thread-safe.
    * So use this method to initialize the handle in the loop thread.
+   *
+   * Same as post().
    */
   void sendQueuedTask(QueuedTask_t&& task) const;
+
+  /**
+   * Queue the task to run in the loop thread, also when it is called from the loop thread.
+   * It is safe to call it from any thread.
+   */
+  void post(QueuedTask_t&& task) const;
+
+  /**
+   * post() the task to the lane of the priority.
+   * The budget (setQueuedTaskBudget) is shared by the high and normal lanes.
+   */
+  void post(QueuedTask_t&& task, TaskPriority priority) const;
+
+  /**
+   * Run the task immediately if it is called from the loop thread, otherwise post() it.
+   * It is safe to call it from any thread.
+   */
+  void dispatch(QueuedTask_t&& task) const;
+
+  /**
+   * @return true if it is called from the thread running this loop.
+   *         The thread is known after the loop has run the first queued tasks after init().
+   */
+  bool isInLoopThread() const;
+
+  /**
+   * @return the thread running this loop, or a default id if it is not known yet
+   */
+  std::thread::id getThreadId() const;
+
+  /**
+   * @return the loop running on the calling thread (known like isInLoopThread), or null
+   */
+  static const Loop* getCurrent();
+
+  /**
+   * `co_await loop->schedule()` resumes the coroutine on the loop thread, it is post()ed also from the loop thread.
+   * See coroutine.h for Task.
+   */
+  LoopScheduleAwaiter schedule(TaskPriority priority = kTaskPriorityNormal) const;
+
+  /**
+   * It is safe to call it from any thread.
+   */
+  void setQueuedTaskBudget(const QueuedTaskBudget& budget);
+  QueuedTaskBudget getQueuedTaskBudget() const;
+
+  /**
+   * It is safe to call it from any thread.
+   */
+  QueuedTaskStats getQueuedTaskStats() const;
+
+  /**
+   * Sockets opened on this loop and not closed yet.
+   * It is safe to call it from any thread.
+   */
+  size_t getSocketCount() const;
+
+  /**
+   * Called by the socket implementations when the handle is opened and closed.
+   */
+  void attachSocket();
+  void detachSocket();
+
+  /**
+   * Start measuring the iterations (prepare handle and uv_metrics_idle_time) and the queued task wait time.
+   * It is cheap enough to be left enabled. It is safe to call it from any thread.
+   */
+  void enableMetrics();
+  bool isMetricsEnabled() const;
+
+  /**
+   * It is safe to call it from any thread.
+   */
+  LoopMetricsSnapshot getMetrics() const;
+
+  /**
+   * Clear the histograms in the loop thread.
+   */
+  void resetMetrics();
+
+  /**
+   * Pool running submitWork, the libuv threadpool (uv_queue_work) is used if it is null.
+   * It is safe to call it from any thread.
+   */
+  void setWorkPool(std::shared_ptr<WorkPool> pool);
+  std::shared_ptr<WorkPool> getWorkPool() const;
+
+  /**
+   * Run work on the work pool, and then completion on the loop thread.
+   * It is safe to call it from any thread.
+   *
+   * On the libuv threadpool the work may not run: uv_queue_work fails or the request is canceled (UV_ECANCELED).
+   * Then neither work nor completion is called, use the overload with error to be notified.
+   * work must not throw: an exception escaping it calls std::terminate on the WorkPool thread.
+   */
+  void submitWork(WorkTask_t&& work, QueuedTask_t&& completion) const;
+
+  /**
+   * Same as submitWork(work, completion), but error(status) is called on the loop thread
+   * instead of completion if the work was not run.
+   */
+  void submitWork(WorkTask_t&& work, QueuedTask_t&& completion, WorkErrorTask_t&& error) const;
+
+  /**
+   * Run work on the work pool, and then completion(R&& result) on the loop thread.
+   * The result is passed without locking.
+   * Like submitWork(work, completion), completion is not called if the work was not run.
+   */
+  template<typename W, typename C, typename R = decltype(std::declval<typename std::decay<W>::type&>()())>
+  typename std::enable_if<!std::is_void<R>::value>::type submitWork(W&& work, C&& completion) const {
+    struct Context {
+      typename std::decay<W>::type work;
+      typename std::decay<C>::type completion;
+      std::unique_ptr<R> result;
+    };
+    std::unique_ptr<Context> context(new Context { std::forward<W>(work), std::forward<C>(completion), nullptr });
+    Context* ptr = context.get();
+    submitWork([ptr]() -> void {
+      ptr->result.reset(new R(ptr->work()));
+    }, [context = std::move(context)]() -> void {
+      context->completion(std::move(*context->result));
+    });
+  }
+};
+
+/**
+ * Awaitable of Loop::schedule().
+ * The coroutine handle type is a template parameter, so that this header does not need C++20.
+ */
+struct LoopScheduleAwaiter {
+  const Loop* loop;
+  TaskPriority priority;
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  template<typename Handle>
+  void await_suspend(Handle handle) const {
+    loop->post([handle]() mutable -> void {
+      handle.resume();
+    }, priority);
+  }
+
+  void await_resume() const noexcept {}
 };
 
+inline LoopScheduleAwaiter Loop::schedule(TaskPriority priority) const {
+  return LoopScheduleAwaiter { this, priority };
+}
+
 class SharedLoop : public Loop {
  public:
   static std::shared_ptr<SharedLoop> create();
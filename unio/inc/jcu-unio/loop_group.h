@@ -0,0 +1,168 @@
+/**
+ * @file	loop_group.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_LOOP_GROUP_H_
+#define JCU_UNIO_LOOP_GROUP_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cpu_topology.h"
+#include "log.h"
+#include "loop.h"
+#include "resource.h"
+#include "work_pool.h"
+
+namespace jcu {
+namespace unio {
+
+enum LoopPlacement {
+  /**
+   * the loops in turn
+   */
+  kPlacementRoundRobin = 0,
+  /**
+   * the loop with the fewest open sockets (Loop::getSocketCount)
+   */
+  kPlacementLeastConnections,
+};
+
+enum LoopAffinity {
+  kAffinityNone = 0,
+  /**
+   * each loop thread is pinned to one CPU, in turn
+   */
+  kAffinityCpu,
+  /**
+   * each loop thread is pinned to the CPUs of one NUMA node, the nodes in turn
+   */
+  kAffinityNumaNode,
+};
+
+struct LoopGroupOptions {
+  /**
+   * number of loops (one thread each), 0 for std::thread::hardware_concurrency()
+   */
+  size_t threads = 0;
+  LoopPlacement placement = kPlacementRoundRobin;
+  /**
+   * optional, set to every loop (Loop::setWorkPool)
+   */
+  std::shared_ptr<WorkPool> work_pool;
+
+  LoopAffinity affinity = kAffinityNone;
+  /**
+   * CPUs used by the affinity, empty for all online CPUs
+   */
+  std::vector<int> cpus;
+  /**
+   * memory policy of the loop threads, for the node they are pinned to
+   * (or running on, if they are not pinned)
+   */
+  NumaMemoryPolicy numa_memory = kNumaMemoryDefault;
+
+  /**
+   * optional, the topology report is logged by start()
+   */
+  std::shared_ptr<Logger> logger;
+};
+
+struct LoopThreadPlacement {
+  size_t index = 0;
+  /**
+   * CPUs the thread is pinned to, empty if it is not pinned
+   */
+  std::vector<int> cpus;
+  /**
+   * -1 if unknown
+   */
+  int numa_node = -1;
+  /**
+   * result of setThreadAffinity
+   */
+  int affinity_error = 0;
+  /**
+   * result of setThreadNumaMemory
+   */
+  int memory_error = 0;
+};
+
+/**
+ * SharedLoops each running on its own thread.
+ *
+ * start() initializes and runs the loops, stop() uninitializes them,
+ * and each thread exits when the handles remaining on its loop are closed.
+ *
+ * @code
+ * auto group = LoopGroup::create(options);
+ * group->start();
+ * auto socket = TCPSocket::create(group->nextParams(basic_params));
+ * ...
+ * group->stop();
+ * group->join();
+ * @endcode
+ */
+class LoopGroup {
+ public:
+  /**
+   * Closes the handles left on the loops (see Loop::closeHandles) and waits for the threads,
+   * so it does not block on an open socket.
+   */
+  virtual ~LoopGroup() = default;
+
+  static std::shared_ptr<LoopGroup> create(const LoopGroupOptions& options = LoopGroupOptions());
+
+  /**
+   * Start the loop threads. Calls after the first one are ignored.
+   */
+  virtual void start() = 0;
+
+  /**
+   * Graceful stop: uninit every loop without closing the handles.
+   * It is safe to call it from any thread, also from a loop thread.
+   */
+  virtual void stop() = 0;
+
+  /**
+   * Wait until every loop thread exits.
+   * It must not be called from a loop thread.
+   */
+  virtual void join() = 0;
+
+  virtual size_t size() const = 0;
+  virtual std::shared_ptr<Loop> getLoop(size_t index) const = 0;
+
+  /**
+   * @return the loop for a new handle by the placement policy
+   */
+  virtual std::shared_ptr<Loop> next() = 0;
+
+  /**
+   * @return copy of params with the loop replaced by next()
+   */
+  virtual BasicParams nextParams(const BasicParams& params) = 0;
+
+  /**
+   * @return placement applied by each loop thread, filled in by start()
+   */
+  virtual std::vector<LoopThreadPlacement> getPlacements() const = 0;
+
+  /**
+   * @return one line per loop: "loop 0: cpus 0-3, numa node 0"
+   */
+  virtual std::string getTopologyReport() const = 0;
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_LOOP_GROUP_H_
@@ -16,6 +16,7 @@
 #include "../buffer.h"
 #include "../event.h"
 #include "../handle.h"
+#include "stream_sink.h"
 
 namespace jcu {
 namespace unio {
@@ -25,16 +26,49 @@ class SocketEndEvent {};
 class SocketReadEvent : public AbstractEvent {
  protected:
   Buffer* buffer_;
+  std::shared_ptr<Buffer> owner_;
+  bool retained_;
 
  public:
   SocketReadEvent(std::shared_ptr<ErrorEvent> error, Buffer* buffer = nullptr);
   SocketReadEvent(Buffer* buffer);
+  SocketReadEvent(std::shared_ptr<Buffer> buffer);
   Buffer* buffer() {
     return buffer_;
   }
   const Buffer* buffer() const {
     return buffer_;
   }
+
+  /**
+   * Take the remaining data without copying.
+   * The socket reads the next data into a new buffer
+   * instead of overwriting the retained one.
+   *
+   * @return empty slice if the buffer can not be retained
+   */
+  BufferSlice retain();
+
+  bool isRetained() const {
+    return retained_;
+  }
+};
+
+/**
+ * Emitted when reading is paused because BasicParams::buffer_budget is under pressure,
+ * and when it is resumed.
+ */
+class SocketPressureEvent {
+ protected:
+  bool paused_;
+
+ public:
+  explicit SocketPressureEvent(bool paused) :
+      paused_(paused) {}
+
+  bool isPaused() const {
+    return paused_;
+  }
 };
 
 class SocketWriteEvent : public AbstractEvent {
@@ -113,12 +147,36 @@ class SockAddrBindParam : public BindParam {
 };
 
 class Socket : public Handle {
+ protected:
+  std::shared_ptr<StreamSink> sink_;
+
  public:
+  /**
+   * Bind the sink, or unbind it with nullptr.
+   * While it is bound, reads, EOF and the completions of the writes without callback
+   * are delivered to it instead of emitting SocketReadEvent, SocketEndEvent and SocketWriteEvent.
+   * Errors are still emitted as ErrorEvent.
+   *
+   * It must be called on the loop thread.
+   */
+  void setSink(std::shared_ptr<StreamSink> sink) {
+    sink_ = std::move(sink);
+  }
+
+  std::shared_ptr<StreamSink> getSink() const {
+    return sink_;
+  }
+
   /**
    * Start reading
    * When there is data to read, SocketReadEvent is emitted.
    *
-   * @param buffer read buffer
+   * @param buffer read buffer.
+   *               If it is nullptr, a buffer is allocated with BasicParams.
+   *               If it is a RingBuffer, it is not cleared between reads:
+   *               new data is appended after the unconsumed data.
+   *               When it is full, reading stops until read() is called again
+   *               after consuming the data.
    */
   virtual void read(
       std::shared_ptr<Buffer> buffer
@@ -144,6 +202,19 @@ class Socket : public Handle {
       CompletionOnceCallback<SocketWriteEvent> callback = nullptr
   ) = 0;
 
+  /**
+   * Write all buffers with a single request (writev).
+   * The callback is called once when every buffer has been written.
+   *
+   * @param buffers data to write.
+   *                The buffers must not be modified until the write is complete.
+   * @param callback
+   */
+  virtual void write(
+      const BufferChain& buffers,
+      CompletionOnceCallback<SocketWriteEvent> callback = nullptr
+  ) = 0;
+
   /**
    * bind
    *
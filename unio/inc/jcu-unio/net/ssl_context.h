@@ -100,6 +100,11 @@ class SSLEngine {
   virtual DataResult wrap(Buffer* input, Buffer* output) = 0;
   virtual DataResult unwrap(Buffer* input, Buffer* output) = 0;
 
+  /**
+   * @return bytes of outbound data that wrap() can move into output now
+   */
+  virtual size_t getOutboundPending() const = 0;
+
   virtual bool shutdown() = 0;
   virtual bool isClosing() const = 0;
 };
@@ -0,0 +1,49 @@
+/**
+ * @file	stream_sink.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_NET_STREAM_SINK_H_
+#define JCU_UNIO_NET_STREAM_SINK_H_
+
+#include "../buffer.h"
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Receives the data of a socket by virtual calls, without the Emitter.
+ * See Socket::setSink. The methods are called on the loop thread.
+ */
+class StreamSink {
+ public:
+  virtual ~StreamSink() = default;
+
+  /**
+   * Data is read, between position and limit of the buffer.
+   * The buffer is reused by the next read, so consume it (move the position) or copy it.
+   * Unconsumed data of a RingBuffer is kept for the next read.
+   */
+  virtual void onRead(Buffer& buffer) = 0;
+
+  /**
+   * A write without callback is complete.
+   *
+   * @param status 0 or UV_xxx error code
+   */
+  virtual void onWriteComplete(int /* status */) {}
+
+  /**
+   * The peer has finished sending (EOF)
+   */
+  virtual void onEnd() {}
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_NET_STREAM_SINK_H_
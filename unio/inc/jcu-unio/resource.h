@@ -18,11 +18,20 @@ namespace unio {
 
 class Loop;
 class Logger;
+class BufferPool;
+class BufferBudget;
 
 struct BasicParams {
   std::shared_ptr<Loop> loop;
   std::shared_ptr<Logger> logger;
-  //TODO: Memory Pool
+  /**
+   * optional, buffers are allocated from the heap if it is null
+   */
+  std::shared_ptr<BufferPool> buffer_pool;
+  /**
+   * optional, buffer memory is not limited if it is null
+   */
+  std::shared_ptr<BufferBudget> buffer_budget;
 };
 
 class Resource {
@@ -0,0 +1,156 @@
+/**
+ * @file	small_vector.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_SMALL_VECTOR_H_
+#define JCU_UNIO_SMALL_VECTOR_H_
+
+#include <stddef.h>
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jcu {
+namespace unio {
+
+/**
+ * Vector keeping up to InlineCount elements inside the object.
+ * It moves to the heap when it grows beyond that, and does not move back.
+ * Like std::vector, growing invalidates the references to the elements.
+ */
+template<typename T, size_t InlineCount>
+class SmallVector {
+ public:
+  SmallVector() :
+      data_(inlineData()), size_(0), capacity_(InlineCount)
+  {}
+
+  SmallVector(const SmallVector&) = delete;
+  SmallVector& operator=(const SmallVector&) = delete;
+
+  ~SmallVector() {
+    clear();
+    if (!isInline()) {
+      ::operator delete(data_);
+    }
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  bool isInline() const {
+    return data_ == inlineData();
+  }
+
+  T& operator[](size_t index) {
+    return data_[index];
+  }
+
+  const T& operator[](size_t index) const {
+    return data_[index];
+  }
+
+  T* begin() {
+    return data_;
+  }
+
+  T* end() {
+    return data_ + size_;
+  }
+
+  T& back() {
+    return data_[size_ - 1];
+  }
+
+  void pop_back() {
+    truncate(size_ - 1);
+  }
+
+  template<typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      grow(capacity_ * 2);
+    }
+    T* item = ::new(static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+    size_++;
+    return *item;
+  }
+
+  /**
+   * Remove the elements matching the predicate, keeping the order of the rest
+   */
+  template<typename P>
+  size_t removeIf(P&& predicate) {
+    size_t out = 0;
+    for (size_t i = 0; i < size_; i++) {
+      if (predicate(data_[i])) {
+        continue;
+      }
+      if (out != i) {
+        data_[out] = std::move(data_[i]);
+      }
+      out++;
+    }
+    size_t removed = size_ - out;
+    truncate(out);
+    return removed;
+  }
+
+  void clear() {
+    truncate(0);
+  }
+
+ private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type inline_[InlineCount];
+  T* data_;
+  size_t size_;
+  size_t capacity_;
+
+  T* inlineData() {
+    return reinterpret_cast<T*>(inline_);
+  }
+
+  const T* inlineData() const {
+    return reinterpret_cast<const T*>(inline_);
+  }
+
+  void truncate(size_t size) {
+    while (size_ > size) {
+      size_--;
+      data_[size_].~T();
+    }
+  }
+
+  void grow(size_t capacity) {
+    T* data = static_cast<T*>(::operator new(sizeof(T) * capacity));
+    for (size_t i = 0; i < size_; i++) {
+      ::new(static_cast<void*>(data + i)) T(std::move(data_[i]));
+      data_[i].~T();
+    }
+    if (!isInline()) {
+      ::operator delete(data_);
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_SMALL_VECTOR_H_
@@ -0,0 +1,218 @@
+/**
+ * @file	unique_function.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_UNIQUE_FUNCTION_H_
+#define JCU_UNIO_UNIQUE_FUNCTION_H_
+
+#include <stddef.h>
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jcu {
+namespace unio {
+
+template<typename Signature, size_t InlineSize = 64>
+class UniqueFunction;
+
+/**
+ * Move-only callable, like std::function but without the copy requirement.
+ *
+ * Callables up to InlineSize bytes (with a nothrow move constructor) are stored inline,
+ * so that the lambdas capturing a few shared_ptr do not allocate.
+ * Larger ones are stored on the heap.
+ */
+template<typename R, typename... Args, size_t InlineSize>
+class UniqueFunction<R(Args...), InlineSize> {
+ public:
+  static const size_t kInlineSize = InlineSize;
+
+ private:
+  typedef typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type Storage;
+
+  struct Ops {
+    R (*invoke)(Storage& storage, Args&&... args);
+    /**
+     * move-construct dst from src and destroy src
+     */
+    void (*relocate)(Storage& dst, Storage& src);
+    void (*destroy)(Storage& storage);
+  };
+
+  template<typename F>
+  struct IsInline {
+    static const bool value = (sizeof(F) <= InlineSize)
+        && (alignof(std::max_align_t) % alignof(F) == 0)
+        && std::is_nothrow_move_constructible<F>::value;
+  };
+
+  template<typename F>
+  struct InlineOps {
+    static F* get(Storage& storage) {
+      return reinterpret_cast<F*>(&storage);
+    }
+    static R invoke(Storage& storage, Args&&... args) {
+      return (*get(storage))(std::forward<Args>(args)...);
+    }
+    static void relocate(Storage& dst, Storage& src) {
+      ::new(static_cast<void*>(&dst)) F(std::move(*get(src)));
+      get(src)->~F();
+    }
+    static void destroy(Storage& storage) {
+      get(storage)->~F();
+    }
+    static const Ops* ops() {
+      static const Ops instance = { invoke, relocate, destroy };
+      return &instance;
+    }
+  };
+
+  template<typename F>
+  struct HeapOps {
+    static F*& get(Storage& storage) {
+      return *reinterpret_cast<F**>(&storage);
+    }
+    static R invoke(Storage& storage, Args&&... args) {
+      return (*get(storage))(std::forward<Args>(args)...);
+    }
+    static void relocate(Storage& dst, Storage& src) {
+      ::new(static_cast<void*>(&dst)) F*(get(src));
+      get(src) = nullptr;
+    }
+    static void destroy(Storage& storage) {
+      delete get(storage);
+    }
+    static const Ops* ops() {
+      static const Ops instance = { invoke, relocate, destroy };
+      return &instance;
+    }
+  };
+
+  template<typename F>
+  struct IsCallable {
+    static const bool value = !std::is_same<typename std::decay<F>::type, UniqueFunction>::value
+        && !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value;
+  };
+
+  Storage storage_;
+  const Ops* ops_;
+
+  template<typename F>
+  void construct(F&& f, std::true_type /* inline */) {
+    typedef typename std::decay<F>::type Fn;
+    ::new(static_cast<void*>(&storage_)) Fn(std::forward<F>(f));
+    ops_ = InlineOps<Fn>::ops();
+  }
+
+  template<typename F>
+  void construct(F&& f, std::false_type /* inline */) {
+    typedef typename std::decay<F>::type Fn;
+    ::new(static_cast<void*>(&storage_)) Fn*(new Fn(std::forward<F>(f)));
+    ops_ = HeapOps<Fn>::ops();
+  }
+
+  template<typename F>
+  static bool isEmpty(const F& f, std::true_type /* nullable */) {
+    return !f;
+  }
+
+  template<typename F>
+  static bool isEmpty(const F& /* f */, std::false_type /* nullable */) {
+    return false;
+  }
+
+ public:
+  UniqueFunction() noexcept :
+      ops_(nullptr)
+  {}
+
+  UniqueFunction(std::nullptr_t) noexcept :
+      ops_(nullptr)
+  {}
+
+  template<typename F, typename = typename std::enable_if<IsCallable<F>::value>::type>
+  UniqueFunction(F&& f) :
+      ops_(nullptr)
+  {
+    typedef typename std::decay<F>::type Fn;
+    // an empty std::function or function pointer makes an empty UniqueFunction
+    if (isEmpty(f, std::integral_constant<bool, std::is_pointer<Fn>::value || std::is_constructible<bool, const Fn&>::value>())) {
+      return ;
+    }
+    construct(std::forward<F>(f), std::integral_constant<bool, IsInline<Fn>::value>());
+  }
+
+  UniqueFunction(UniqueFunction&& other) noexcept :
+      ops_(other.ops_)
+  {
+    if (ops_) {
+      ops_->relocate(storage_, other.storage_);
+      other.ops_ = nullptr;
+    }
+  }
+
+  UniqueFunction(const UniqueFunction&) = delete;
+  UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+  ~UniqueFunction() {
+    reset();
+  }
+
+  UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.ops_) {
+        other.ops_->relocate(storage_, other.storage_);
+        ops_ = other.ops_;
+        other.ops_ = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  UniqueFunction& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  void reset() noexcept {
+    if (ops_) {
+      const Ops* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(storage_);
+    }
+  }
+
+  explicit operator bool() const noexcept {
+    return ops_ != nullptr;
+  }
+
+  R operator()(Args... args) {
+    if (!ops_) {
+      throw std::bad_function_call();
+    }
+    return ops_->invoke(storage_, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @return true if F is stored without a heap allocation
+   */
+  template<typename F>
+  static constexpr bool isInline() {
+    return IsInline<typename std::decay<F>::type>::value;
+  }
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_UNIQUE_FUNCTION_H_
@@ -28,6 +28,15 @@ class UvRefBase {
   virtual void close() {
     delete this;
   }
+  /**
+   * Close the handle when its loop is torn down, see Loop::closeHandles
+   */
+  virtual void forceClose() {
+    uv_close(baseHandle(), [](uv_handle_t* handle) -> void {
+      UvRefBase* self = (UvRefBase*) uv_handle_get_data(handle);
+      self->close();
+    });
+  }
 };
 
 /**
@@ -143,6 +152,10 @@ class UvCallbackRef : public UvRefBase {
     fn_ = std::move(fn);
   }
 
+  bool hasCallback() const {
+    return (bool) fn_;
+  }
+
   void publish(E event) {
     if (fn_) {
       fn_(event, *data_);
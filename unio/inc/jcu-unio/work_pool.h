@@ -0,0 +1,59 @@
+/**
+ * @file	work_pool.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_WORK_POOL_H_
+#define JCU_UNIO_WORK_POOL_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "unique_function.h"
+
+namespace jcu {
+namespace unio {
+
+typedef UniqueFunction<void(), 96> WorkTask_t;
+
+/**
+ * Threads running CPU-heavy work off the loops.
+ *
+ * It is independent of the libuv threadpool (UV_THREADPOOL_SIZE),
+ * and can be shared by several loops (Loop::setWorkPool).
+ * It is thread-safe.
+ */
+class WorkPool {
+ public:
+  virtual ~WorkPool() = default;
+
+  /**
+   * @param threads 0 for std::thread::hardware_concurrency()
+   */
+  static std::shared_ptr<WorkPool> create(size_t threads = 0);
+
+  virtual size_t getThreadCount() const = 0;
+
+  /**
+   * work must not throw, an exception escaping it calls std::terminate.
+   *
+   * @return false if the pool is shut down (work is destroyed without running)
+   */
+  virtual bool submit(WorkTask_t&& work) = 0;
+
+  /**
+   * Run the submitted work and stop the threads.
+   * It is called by the destructor.
+   */
+  virtual void shutdown() = 0;
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_WORK_POOL_H_
@@ -7,47 +7,250 @@
  *            of the Apache License 2.0.  See the LICENSE file for details.
  */
 
-#include <vector>
+#include <stdlib.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <cstring>
+#include <algorithm>
 
 #include <jcu-unio/buffer.h>
 
 namespace jcu {
 namespace unio {
 
-class VectorBuffer : public Buffer {
+namespace {
+
+size_t normalizeAlignment(size_t alignment) {
+  if (alignment == 0) {
+    return 0;
+  }
+  size_t normalized = sizeof(void*);
+  while (normalized < alignment) {
+    normalized <<= 1;
+  }
+  return normalized;
+}
+
+void* alignedAlloc(size_t size, size_t alignment) {
+#if defined(_WIN32)
+  return ::_aligned_malloc(size, alignment);
+#else
+  void* ptr = nullptr;
+  if (::posix_memalign(&ptr, alignment, size) != 0) {
+    return nullptr;
+  }
+  return ptr;
+#endif
+}
+
+void alignedFree(void* ptr) {
+#if defined(_WIN32)
+  ::_aligned_free(ptr);
+#else
+  ::free(ptr);
+#endif
+}
+
+#if defined(__linux__)
+/**
+ * @param size multiple of FlatBuffer::kHugePageSize
+ */
+void* mapHugePages(size_t size) {
+  void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr != MAP_FAILED) {
+    return ptr;
+  }
+
+  // no reserved huge pages: map a huge page aligned range and ask for transparent huge pages
+  const size_t huge_page_size = FlatBuffer::kHugePageSize;
+  size_t map_size = size + huge_page_size;
+  char* map = (char*) ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED) {
+    return nullptr;
+  }
+  char* aligned = (char*) (((uintptr_t) map + huge_page_size - 1) & ~(uintptr_t) (huge_page_size - 1));
+  size_t head = aligned - map;
+  size_t tail = map_size - head - size;
+  if (head) ::munmap(map, head);
+  if (tail) ::munmap(aligned + size, tail);
+  ::madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+}
+#endif
+
+} // namespace
+
+FlatBuffer::FlatBuffer(size_t initial_size, size_t expandable_size, const BufferOptions& options) :
+    buf_(nullptr),
+    storage_size_(0),
+    capacity_(0),
+    expandable_size_(expandable_size),
+    position_(0),
+    limit_(0),
+    options_(options),
+    mapped_(false)
+{
+  options_.alignment = normalizeAlignment(options_.alignment);
+#if !defined(__linux__)
+  options_.huge_pages = false;
+#endif
+  if (resizeStorage(initial_size)) {
+    capacity_ = initial_size;
+    if (options_.zero_fill) {
+      std::memset(buf_, 0, initial_size);
+    }
+  }
+}
+
+FlatBuffer::~FlatBuffer() {
+  if (mapped_) {
+#if defined(__linux__)
+    ::munmap(buf_, storage_size_);
+#endif
+  } else if (options_.alignment || options_.huge_pages) {
+    // allocated by alignedAlloc in resizeStorage
+    alignedFree(buf_);
+  } else {
+    ::free(buf_);
+  }
+}
+
+/**
+ * realloc is used so that large (mmap-ed) blocks can be remapped instead of copied.
+ * Aligned and huge page storage is moved to a new allocation.
+ */
+bool FlatBuffer::resizeStorage(size_t size) {
+  if (!options_.alignment && !options_.huge_pages) {
+    char* ptr = (char*) ::realloc(buf_, size ? size : 1);
+    if (!ptr) {
+      return false;
+    }
+    buf_ = ptr;
+    storage_size_ = size;
+    return true;
+  }
+
+  char* ptr = nullptr;
+  bool mapped = false;
+  size = roundStorageSize(size);
+#if defined(__linux__)
+  if (options_.huge_pages && (size >= kHugePageSize)) {
+    ptr = (char*) mapHugePages(size);
+    mapped = (ptr != nullptr);
+  }
+#endif
+  if (!ptr) {
+    size_t alignment = options_.alignment ? options_.alignment : sizeof(void*);
+    ptr = (char*) alignedAlloc(size ? size : 1, alignment);
+    if (!ptr) {
+      return false;
+    }
+  }
+
+  if (buf_) {
+    std::memcpy(ptr, buf_, std::min(capacity_, size));
+    if (mapped_) {
+#if defined(__linux__)
+      ::munmap(buf_, storage_size_);
+#endif
+    } else {
+      alignedFree(buf_);
+    }
+  }
+  buf_ = ptr;
+  storage_size_ = size;
+  mapped_ = mapped;
+  return true;
+}
+
+size_t FlatBuffer::roundStorageSize(size_t size) const {
+  if (options_.huge_pages && (size >= kHugePageSize)) {
+    return (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  }
+  return size;
+}
+
+size_t FlatBuffer::getStorageSizeForExpand(size_t size) const {
+  size_t new_size = std::min(size, getExpandableSize());
+  if (new_size <= storage_size_) {
+    return storage_size_;
+  }
+  // grow geometrically
+  return roundStorageSize(std::min(std::max(new_size, storage_size_ * 2), getExpandableSize()));
+}
+
+size_t FlatBuffer::getStorageSizeForReserve(size_t size) const {
+  size = std::min(size, getExpandableSize());
+  if (size <= storage_size_) {
+    return storage_size_;
+  }
+  return roundStorageSize(size);
+}
+
+void FlatBuffer::expand(size_t size) {
+  size_t expandable_size = getExpandableSize();
+  size_t new_size = (size <= expandable_size) ? size : expandable_size;
+  if ((new_size <= capacity_) || (expandable_size <= capacity())) {
+    return ;
+  }
+  if (new_size > storage_size_) {
+    if (!resizeStorage(getStorageSizeForExpand(new_size))) {
+      return ;
+    }
+  }
+  if (options_.zero_fill) {
+    std::memset(buf_ + capacity_, 0, new_size - capacity_);
+  }
+  capacity_ = new_size;
+}
+
+void FlatBuffer::reserve(size_t size) {
+  size = std::min(size, getExpandableSize());
+  if (size > storage_size_) {
+    resizeStorage(size);
+  }
+}
+
+/**
+ * Buffer view over a BufferSlice
+ */
+class SliceBuffer : public Buffer {
  protected:
-  std::vector<char> buf_;
-  size_t expandable_size_;
+  BufferSlice slice_;
   size_t position_;
   size_t limit_;
 
  public:
-  VectorBuffer(size_t initial_size, size_t expandable_size) :
-      expandable_size_(expandable_size),
+  SliceBuffer(BufferSlice slice) :
+      slice_(std::move(slice)),
       position_(0),
-      limit_(0)
-  {
-    buf_.resize(initial_size);
-  }
+      limit_(slice_.size())
+  {}
 
   void *base() override {
-    return buf_.data();
+    return (void*) slice_.data();
   }
 
   const void *base() const override {
-    return buf_.data();
+    return slice_.data();
   }
 
   void *data() override {
-    return buf_.data() + position();
+    return (char*) slice_.data() + position();
   }
 
   const void *data() const override {
-    return buf_.data() + position();
+    return (const char*) slice_.data() + position();
   }
 
   size_t capacity() const override {
-    return buf_.size();
+    return slice_.size();
   }
 
   size_t position() const override {
@@ -77,25 +280,31 @@ class VectorBuffer : public Buffer {
   }
 
   size_t getExpandableSize() const override {
-    return expandable_size_;
+    return capacity();
   }
 
-  void expand(size_t size) override {
-    size_t expandable_size = getExpandableSize();
-    size_t new_size = (size <= expandable_size) ? size : expandable_size;
-    if ((new_size <= buf_.size()) || (expandable_size <= capacity())) {
-      return ;
-    }
-    buf_.resize(new_size);
+  void expand(size_t /* size */) override {
   }
 };
 
+std::shared_ptr<Buffer> BufferSlice::asBuffer() const {
+  return std::make_shared<SliceBuffer>(*this);
+}
+
 std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size) {
-  return std::make_shared<VectorBuffer>(size, size);
+  return std::make_shared<FlatBuffer>(size, size, BufferOptions());
+}
+
+std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size, const BufferOptions& options) {
+  return createExpandableBuffer(size, size, options);
 }
 
 std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size) {
-  return std::make_shared<VectorBuffer>(initial_size, expandable_size);
+  return std::make_shared<FlatBuffer>(initial_size, expandable_size, BufferOptions());
+}
+
+std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size, const BufferOptions& options) {
+  return std::make_shared<FlatBuffer>(initial_size, expandable_size, options);
 }
 
 } // namespace unio
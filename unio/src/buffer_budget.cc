@@ -0,0 +1,122 @@
+/**
+ * @file	buffer_budget.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <jcu-unio/buffer_budget.h>
+
+namespace jcu {
+namespace unio {
+
+class BufferBudgetImpl : public BufferBudget {
+ public:
+  size_t limit_;
+  size_t pressure_threshold_;
+
+  std::atomic<size_t> total_usage_;
+  std::atomic<size_t> usage_[kBufferCategoryCount];
+
+  std::mutex waiters_mutex_;
+  /**
+   * set while waiters_ is not empty, so that release() does not lock on every call
+   */
+  std::atomic<bool> has_waiters_;
+  std::vector<UniqueFunction<void()>> waiters_;
+
+  BufferBudgetImpl(size_t limit, size_t pressure_threshold) :
+      limit_(limit),
+      pressure_threshold_(pressure_threshold),
+      total_usage_(0),
+      has_waiters_(false)
+  {
+    for (auto& usage : usage_) {
+      usage.store(0);
+    }
+  }
+
+  size_t getLimit() const override {
+    return limit_;
+  }
+
+  size_t getPressureThreshold() const override {
+    return pressure_threshold_;
+  }
+
+  size_t getUsage(BufferCategory category) const override {
+    return usage_[category].load(std::memory_order_relaxed);
+  }
+
+  size_t getTotalUsage() const override {
+    return total_usage_.load(std::memory_order_relaxed);
+  }
+
+  bool isUnderPressure() const override {
+    return total_usage_.load() >= pressure_threshold_;
+  }
+
+  bool acquire(BufferCategory category, size_t bytes) override {
+    size_t usage = total_usage_.load(std::memory_order_relaxed);
+    do {
+      if ((bytes > limit_) || (usage > limit_ - bytes)) {
+        return false;
+      }
+    } while (!total_usage_.compare_exchange_weak(usage, usage + bytes));
+    usage_[category].fetch_add(bytes, std::memory_order_relaxed);
+    return true;
+  }
+
+  void release(BufferCategory category, size_t bytes) override {
+    usage_[category].fetch_sub(bytes, std::memory_order_relaxed);
+    size_t usage = total_usage_.fetch_sub(bytes) - bytes;
+    if ((usage < pressure_threshold_) && has_waiters_.load()) {
+      notifyWaiters();
+    }
+  }
+
+  void waitForRelief(UniqueFunction<void()> fn) override {
+    {
+      std::lock_guard<std::mutex> lock(waiters_mutex_);
+      has_waiters_.store(true);
+      if (isUnderPressure()) {
+        waiters_.emplace_back(std::move(fn));
+        return ;
+      }
+      has_waiters_.store(!waiters_.empty());
+    }
+    fn();
+  }
+
+  void notifyWaiters() {
+    std::vector<UniqueFunction<void()>> waiters;
+    {
+      std::lock_guard<std::mutex> lock(waiters_mutex_);
+      if (isUnderPressure()) {
+        return ;
+      }
+      waiters.swap(waiters_);
+      has_waiters_.store(false);
+    }
+    for (auto& fn : waiters) {
+      fn();
+    }
+  }
+};
+
+std::shared_ptr<BufferBudget> BufferBudget::create(size_t limit) {
+  return create(limit, limit - limit / 10);
+}
+
+std::shared_ptr<BufferBudget> BufferBudget::create(size_t limit, size_t pressure_threshold) {
+  return std::make_shared<BufferBudgetImpl>(limit, (pressure_threshold <= limit) ? pressure_threshold : limit);
+}
+
+} // namespace unio
+} // namespace jcu
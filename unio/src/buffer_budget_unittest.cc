@@ -0,0 +1,149 @@
+/**
+ * @file	buffer_budget_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <gtest/gtest.h>
+
+#include <jcu-unio/buffer_budget.h>
+#include <jcu-unio/buffer_pool.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+class BufferBudgetTest : public ::testing::Test {
+};
+
+TEST_F(BufferBudgetTest, AccountByCategory) {
+  BasicParams basic_params;
+  basic_params.buffer_budget = BufferBudget::create(10000, 8000);
+  auto budget = basic_params.buffer_budget;
+
+  auto read_buffer = createFixedSizeBuffer(basic_params, 4000, kBufferRead);
+  ASSERT_NE(read_buffer, nullptr);
+  {
+    auto write_buffer = createFixedSizeBuffer(basic_params, 3000, kBufferWrite);
+    ASSERT_NE(write_buffer, nullptr);
+    EXPECT_EQ(budget->getUsage(kBufferRead), 4000);
+    EXPECT_EQ(budget->getUsage(kBufferWrite), 3000);
+    EXPECT_EQ(budget->getUsage(kBufferTls), 0);
+    EXPECT_EQ(budget->getTotalUsage(), 7000);
+    EXPECT_FALSE(budget->isUnderPressure());
+
+    // over the limit
+    EXPECT_EQ(createFixedSizeBuffer(basic_params, 3001, kBufferTls), nullptr);
+    EXPECT_EQ(budget->getUsage(kBufferTls), 0);
+
+    auto tls_buffer = createFixedSizeBuffer(basic_params, 3000, kBufferTls);
+    ASSERT_NE(tls_buffer, nullptr);
+    EXPECT_TRUE(budget->isUnderPressure());
+  }
+  EXPECT_EQ(budget->getUsage(kBufferWrite), 0);
+  EXPECT_EQ(budget->getUsage(kBufferTls), 0);
+  EXPECT_EQ(budget->getTotalUsage(), 4000);
+  EXPECT_FALSE(budget->isUnderPressure());
+}
+
+TEST_F(BufferBudgetTest, ExpandWithinLimit) {
+  BasicParams basic_params;
+  basic_params.buffer_budget = BufferBudget::create(10000);
+  auto budget = basic_params.buffer_budget;
+
+  auto buffer = createExpandableBuffer(basic_params, 1000, 20000, kBufferRead);
+  buffer->expand(6000);
+  EXPECT_EQ(buffer->capacity(), 6000);
+  EXPECT_EQ(budget->getUsage(kBufferRead), 6000);
+
+  // not expanded over the limit
+  buffer->expand(12000);
+  EXPECT_EQ(buffer->capacity(), 6000);
+  EXPECT_EQ(budget->getUsage(kBufferRead), 6000);
+
+  buffer.reset();
+  EXPECT_EQ(budget->getTotalUsage(), 0);
+}
+
+TEST_F(BufferBudgetTest, FixedBuffersKeepTheirType) {
+  BasicParams basic_params;
+  basic_params.buffer_budget = BufferBudget::create(100000);
+  auto budget = basic_params.buffer_budget;
+
+  // the read paths of TCPSocket detect these types
+  auto fixed_buffer = createFixedSizeBuffer(basic_params, 1000, kBufferRead);
+  EXPECT_NE(FlatBuffer::from(fixed_buffer.get()), nullptr);
+  auto expandable_buffer = createExpandableBuffer(basic_params, 2000, 2000, kBufferRead);
+  EXPECT_NE(FlatBuffer::from(expandable_buffer.get()), nullptr);
+  EXPECT_EQ(budget->getUsage(kBufferRead), 3000);
+
+  auto ring_buffer = createRingBuffer(basic_params, 4096, kBufferRead);
+  if (ring_buffer) {
+    EXPECT_EQ(budget->getUsage(kBufferRead), 3000 + ring_buffer->capacity());
+  }
+
+  fixed_buffer.reset();
+  expandable_buffer.reset();
+  ring_buffer.reset();
+  EXPECT_EQ(budget->getTotalUsage(), 0);
+}
+
+TEST_F(BufferBudgetTest, AccountAllocatedSize) {
+  BasicParams basic_params;
+  basic_params.buffer_budget = BufferBudget::create(100000);
+  auto budget = basic_params.buffer_budget;
+
+  // rounded up to the page size
+  auto ring_buffer = createRingBuffer(basic_params, 100, kBufferRead);
+  if (ring_buffer) {
+    EXPECT_GE(ring_buffer->capacity(), 4096);
+    EXPECT_EQ(budget->getUsage(kBufferRead), ring_buffer->capacity());
+    ring_buffer.reset();
+  }
+
+  // storage grows geometrically
+  auto flat_buffer = createExpandableBuffer(basic_params, 1000, 20000, kBufferWrite);
+  flat_buffer->expand(1500);
+  EXPECT_EQ(flat_buffer->capacity(), 1500);
+  EXPECT_EQ(budget->getUsage(kBufferWrite), 2000);
+  flat_buffer->reserve(5000);
+  EXPECT_EQ(budget->getUsage(kBufferWrite), 5000);
+  flat_buffer.reset();
+
+  // the block of the size class
+  basic_params.buffer_pool = BufferPool::create({4096, 16384}, 65536);
+  auto pooled_buffer = createFixedSizeBuffer(basic_params, 100, kBufferTls);
+  EXPECT_EQ(budget->getUsage(kBufferTls), 4096);
+  auto pooled_expandable_buffer = createExpandableBuffer(basic_params, 100, 10000, kBufferTls);
+  pooled_expandable_buffer->expand(5000);
+  EXPECT_EQ(budget->getUsage(kBufferTls), 4096 + 16384);
+
+  pooled_buffer.reset();
+  pooled_expandable_buffer.reset();
+  EXPECT_EQ(budget->getTotalUsage(), 0);
+}
+
+TEST_F(BufferBudgetTest, WaitForRelief) {
+  auto budget = BufferBudget::create(1000, 500);
+  int called = 0;
+
+  budget->waitForRelief([&]() -> void { called++; });
+  EXPECT_EQ(called, 1);
+
+  ASSERT_TRUE(budget->acquire(kBufferOther, 600));
+  budget->waitForRelief([&]() -> void { called++; });
+  EXPECT_EQ(called, 1);
+
+  budget->release(kBufferOther, 50);
+  EXPECT_EQ(called, 1);
+  budget->release(kBufferOther, 100);
+  EXPECT_EQ(called, 2);
+
+  budget->release(kBufferOther, 450);
+  EXPECT_EQ(called, 2);
+}
+
+}
@@ -0,0 +1,536 @@
+/**
+ * @file	buffer_pool.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <jcu-unio/buffer_pool.h>
+
+namespace jcu {
+namespace unio {
+
+namespace {
+
+const size_t kDefaultSizeClasses[] = {4096, 16384, 65536};
+const size_t kDefaultSlabSize = 262144;
+
+struct PoolBlock {
+  char *ptr;
+  /**
+   * index of the size class, -1 if allocated from the heap
+   */
+  int size_class;
+  size_t size;
+};
+
+class SizeClass {
+ public:
+  size_t block_size;
+  size_t blocks_per_slab;
+
+  std::mutex mutex;
+  std::vector<char *> free_blocks;
+  std::vector<std::unique_ptr<char[]>> slabs;
+
+  SizeClass(size_t block_size, size_t slab_size) :
+      block_size(block_size),
+      blocks_per_slab(std::max<size_t>(1, slab_size / std::max<size_t>(1, block_size)))
+  {}
+
+  char *acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_blocks.empty()) {
+      std::unique_ptr<char[]> slab(new char[block_size * blocks_per_slab]);
+      for (size_t i = blocks_per_slab; i > 0; i--) {
+        free_blocks.push_back(slab.get() + (i - 1) * block_size);
+      }
+      slabs.emplace_back(std::move(slab));
+    }
+    char *ptr = free_blocks.back();
+    free_blocks.pop_back();
+    return ptr;
+  }
+
+  void release(char *ptr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_blocks.push_back(ptr);
+  }
+
+  /**
+   * Free the slabs whose blocks are all free
+   *
+   * @return bytes freed
+   */
+  size_t trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t slab_bytes = block_size * blocks_per_slab;
+    size_t freed = 0;
+    for (size_t i = slabs.size(); i > 0; i--) {
+      char *begin = slabs[i - 1].get();
+      char *end = begin + slab_bytes;
+      auto in_slab = [begin, end](char *ptr) -> bool {
+        return (ptr >= begin) && (ptr < end);
+      };
+      if ((size_t) std::count_if(free_blocks.begin(), free_blocks.end(), in_slab) != blocks_per_slab) {
+        continue;
+      }
+      free_blocks.erase(std::remove_if(free_blocks.begin(), free_blocks.end(), in_slab), free_blocks.end());
+      slabs.erase(slabs.begin() + (i - 1));
+      freed += slab_bytes;
+    }
+    return freed;
+  }
+};
+
+} // namespace
+
+class BufferPoolImpl : public BufferPool {
+ public:
+  std::weak_ptr<BufferPoolImpl> self_;
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+
+  BufferPoolImpl(std::vector<size_t> size_classes, size_t slab_size) {
+    std::sort(size_classes.begin(), size_classes.end());
+    size_classes.erase(std::unique(size_classes.begin(), size_classes.end()), size_classes.end());
+    for (size_t block_size : size_classes) {
+      size_classes_.emplace_back(new SizeClass(block_size, slab_size));
+    }
+  }
+
+  /**
+   * @return index of the smallest class for size, -1 for the heap
+   */
+  int findSizeClass(size_t size) const {
+    for (size_t i = 0; i < size_classes_.size(); i++) {
+      if (size <= size_classes_[i]->block_size) {
+        return (int) i;
+      }
+    }
+    return -1;
+  }
+
+  /**
+   * @return bytes of the block acquire(size) returns
+   */
+  size_t getBlockSize(size_t size) const {
+    int index = findSizeClass(size);
+    return (index < 0) ? size : size_classes_[index]->block_size;
+  }
+
+  PoolBlock acquire(size_t size) {
+    int index = findSizeClass(size);
+    if (index < 0) {
+      return PoolBlock{new char[size], -1, size};
+    }
+    SizeClass *size_class = size_classes_[index].get();
+    return PoolBlock{size_class->acquire(), index, size_class->block_size};
+  }
+
+  void release(const PoolBlock &block) {
+    if (!block.ptr) return;
+    if (block.size_class < 0) {
+      delete[] block.ptr;
+    } else {
+      size_classes_[block.size_class]->release(block.ptr);
+    }
+  }
+
+  size_t trim() override {
+    size_t freed = 0;
+    for (auto &size_class : size_classes_) {
+      freed += size_class->trim();
+    }
+    return freed;
+  }
+
+  std::shared_ptr<Buffer> createFixedSizeBuffer(size_t size) override;
+  std::shared_ptr<Buffer> createExpandableBuffer(size_t initial_size, size_t expandable_size) override;
+};
+
+class PooledBuffer : public Buffer {
+ protected:
+  std::shared_ptr<BufferPoolImpl> pool_;
+  PoolBlock block_;
+  size_t capacity_;
+  size_t expandable_size_;
+  size_t position_;
+  size_t limit_;
+
+ public:
+  PooledBuffer(std::shared_ptr<BufferPoolImpl> pool, size_t initial_size, size_t expandable_size) :
+      pool_(std::move(pool)),
+      capacity_(initial_size),
+      expandable_size_(expandable_size),
+      position_(0),
+      limit_(0)
+  {
+    block_ = pool_->acquire(initial_size);
+  }
+
+  ~PooledBuffer() override {
+    pool_->release(block_);
+  }
+
+  void *base() override {
+    return block_.ptr;
+  }
+
+  const void *base() const override {
+    return block_.ptr;
+  }
+
+  void *data() override {
+    return block_.ptr + position();
+  }
+
+  const void *data() const override {
+    return block_.ptr + position();
+  }
+
+  size_t capacity() const override {
+    return capacity_;
+  }
+
+  size_t position() const override {
+    return position_;
+  }
+
+  void position(size_t size) override {
+    position_ = size;
+  }
+
+  void limit(size_t size) override {
+    limit_ = size;
+  }
+
+  size_t remaining() const override {
+    return limit_ - position_;
+  }
+
+  void flip() override {
+    limit_ = position_;
+    position_ = 0;
+  }
+
+  void clear() override {
+    position_ = 0;
+    limit_ = capacity();
+  }
+
+  size_t getExpandableSize() const override {
+    return expandable_size_;
+  }
+
+  size_t getBlockSize() const {
+    return block_.size;
+  }
+
+  /**
+   * @return getBlockSize() after expand(size)
+   */
+  size_t getBlockSizeForExpand(size_t size) const {
+    size_t new_size = std::min(size, getExpandableSize());
+    return (new_size <= block_.size) ? block_.size : pool_->getBlockSize(new_size);
+  }
+
+  void expand(size_t size) override {
+    size_t expandable_size = getExpandableSize();
+    size_t new_size = (size <= expandable_size) ? size : expandable_size;
+    if ((new_size <= capacity_) || (expandable_size <= capacity())) {
+      return ;
+    }
+    if (new_size > block_.size) {
+      PoolBlock new_block = pool_->acquire(new_size);
+      std::memcpy(new_block.ptr, block_.ptr, capacity_);
+      pool_->release(block_);
+      block_ = new_block;
+    }
+    capacity_ = new_size;
+  }
+};
+
+std::shared_ptr<Buffer> BufferPoolImpl::createFixedSizeBuffer(size_t size) {
+  return std::make_shared<PooledBuffer>(self_.lock(), size, size);
+}
+
+std::shared_ptr<Buffer> BufferPoolImpl::createExpandableBuffer(size_t initial_size, size_t expandable_size) {
+  return std::make_shared<PooledBuffer>(self_.lock(), initial_size, expandable_size);
+}
+
+std::shared_ptr<BufferPool> BufferPool::create() {
+  return create(
+      std::vector<size_t>(std::begin(kDefaultSizeClasses), std::end(kDefaultSizeClasses)),
+      kDefaultSlabSize
+  );
+}
+
+std::shared_ptr<BufferPool> BufferPool::create(const std::vector<size_t> &size_classes, size_t slab_size) {
+  std::shared_ptr<BufferPoolImpl> instance(new BufferPoolImpl(size_classes, slab_size));
+  instance->self_ = instance;
+  return instance;
+}
+
+/**
+ * @return bytes of memory held by buffer, which may be more than its capacity:
+ *         the storage of a FlatBuffer, the block of a PooledBuffer,
+ *         the pages of a RingBuffer (mapped twice, but in memory once)
+ */
+static size_t getAllocatedSize(Buffer* buffer) {
+  FlatBuffer* flat_buffer = FlatBuffer::from(buffer);
+  if (flat_buffer) {
+    return flat_buffer->getStorageSize();
+  }
+  PooledBuffer* pooled_buffer = dynamic_cast<PooledBuffer*>(buffer);
+  if (pooled_buffer) {
+    return pooled_buffer->getBlockSize();
+  }
+  return buffer->capacity();
+}
+
+/**
+ * @return getAllocatedSize() after expand(size)
+ */
+static size_t getAllocatedSizeForExpand(Buffer* buffer, size_t size) {
+  FlatBuffer* flat_buffer = FlatBuffer::from(buffer);
+  if (flat_buffer) {
+    return flat_buffer->getStorageSizeForExpand(size);
+  }
+  PooledBuffer* pooled_buffer = dynamic_cast<PooledBuffer*>(buffer);
+  if (pooled_buffer) {
+    return pooled_buffer->getBlockSizeForExpand(size);
+  }
+  return std::max(buffer->capacity(), std::min(size, buffer->getExpandableSize()));
+}
+
+/**
+ * @return getAllocatedSize() after reserve(size)
+ */
+static size_t getAllocatedSizeForReserve(Buffer* buffer, size_t size) {
+  FlatBuffer* flat_buffer = FlatBuffer::from(buffer);
+  if (flat_buffer) {
+    return flat_buffer->getStorageSizeForReserve(size);
+  }
+  return getAllocatedSize(buffer);
+}
+
+/**
+ * Accounts the memory of the wrapped buffer to a BufferBudget, including expand() and reserve().
+ * Only used for buffers that can grow, see accountFixedBuffer.
+ */
+class AccountedBuffer : public Buffer {
+ protected:
+  std::shared_ptr<Buffer> buffer_;
+  std::shared_ptr<BufferBudget> budget_;
+  BufferCategory category_;
+  size_t accounted_;
+
+ public:
+  /**
+   * @param accounted bytes already acquired from budget
+   */
+  AccountedBuffer(std::shared_ptr<Buffer> buffer, std::shared_ptr<BufferBudget> budget, BufferCategory category, size_t accounted) :
+      buffer_(std::move(buffer)),
+      budget_(std::move(budget)),
+      category_(category),
+      accounted_(accounted)
+  {}
+
+  ~AccountedBuffer() override {
+    budget_->release(category_, accounted_);
+  }
+
+  void *base() override {
+    return buffer_->base();
+  }
+
+  const void *base() const override {
+    return buffer_->base();
+  }
+
+  void *data() override {
+    return buffer_->data();
+  }
+
+  const void *data() const override {
+    return buffer_->data();
+  }
+
+  size_t capacity() const override {
+    return buffer_->capacity();
+  }
+
+  size_t position() const override {
+    return buffer_->position();
+  }
+
+  void position(size_t size) override {
+    buffer_->position(size);
+  }
+
+  void limit(size_t size) override {
+    buffer_->limit(size);
+  }
+
+  size_t remaining() const override {
+    return buffer_->remaining();
+  }
+
+  void flip() override {
+    buffer_->flip();
+  }
+
+  void clear() override {
+    buffer_->clear();
+  }
+
+  size_t getExpandableSize() const override {
+    return buffer_->getExpandableSize();
+  }
+
+  void expand(size_t size) override {
+    if (acquireUpTo(getAllocatedSizeForExpand(buffer_.get(), size))) {
+      buffer_->expand(size);
+    } else if (acquireUpTo(getAllocatedSizeForReserve(buffer_.get(), size))) {
+      // the geometric growth does not fit, but the exact size does
+      buffer_->reserve(size);
+      buffer_->expand(size);
+    }
+    settle();
+  }
+
+  void reserve(size_t size) override {
+    if (acquireUpTo(getAllocatedSizeForReserve(buffer_.get(), size))) {
+      buffer_->reserve(size);
+    }
+    settle();
+  }
+
+ private:
+  /**
+   * Account up to allocated bytes before allocating them
+   *
+   * @return false if it would exceed the limit
+   */
+  bool acquireUpTo(size_t allocated) {
+    if (allocated <= accounted_) {
+      return true;
+    }
+    if (!budget_->acquire(category_, allocated - accounted_)) {
+      return false;
+    }
+    accounted_ = allocated;
+    return true;
+  }
+
+  /**
+   * Release what was accounted but not allocated (e.g. the allocation failed)
+   */
+  void settle() {
+    size_t allocated = getAllocatedSize(buffer_.get());
+    if (allocated < accounted_) {
+      budget_->release(category_, accounted_ - allocated);
+      accounted_ = allocated;
+    }
+  }
+};
+
+/**
+ * Create a buffer and account the memory it allocated.
+ * The requested size is accounted before allocating,
+ * then the rest of the allocation (size class, page rounding).
+ *
+ * @param accounted bytes accounted if it succeeds
+ * @return nullptr if it would exceed the limit
+ */
+template <class T>
+static std::shared_ptr<T> createAccounted(BufferBudget* budget, BufferCategory category, size_t size, const std::function<std::shared_ptr<T>()>& create, size_t* accounted) {
+  if (!budget->acquire(category, size)) {
+    return nullptr;
+  }
+  std::shared_ptr<T> buffer(create());
+  size_t allocated = buffer ? getAllocatedSize(buffer.get()) : 0;
+  if (allocated > size) {
+    if (!budget->acquire(category, allocated - size)) {
+      budget->release(category, size);
+      return nullptr;
+    }
+  } else {
+    budget->release(category, size - allocated);
+  }
+  *accounted = allocated;
+  return buffer;
+}
+
+static std::shared_ptr<Buffer> accountBuffer(const BasicParams &basic_params, BufferCategory category, size_t size, const std::function<std::shared_ptr<Buffer>()>& create) {
+  if (!basic_params.buffer_budget) {
+    return create();
+  }
+  size_t accounted = 0;
+  std::shared_ptr<Buffer> buffer(createAccounted(basic_params.buffer_budget.get(), category, size, create, &accounted));
+  if (!buffer) {
+    return nullptr;
+  }
+  return std::make_shared<AccountedBuffer>(std::move(buffer), basic_params.buffer_budget, category, accounted);
+}
+
+/**
+ * Accounts a buffer that cannot grow.
+ * The budget is released by the deleter of the returned shared_ptr instead of a wrapper,
+ * so the buffer keeps its own type for FlatBuffer::from() and the RingBuffer read path.
+ */
+template <class T>
+static std::shared_ptr<T> accountFixedBuffer(const BasicParams &basic_params, BufferCategory category, size_t size, const std::function<std::shared_ptr<T>()>& create) {
+  std::shared_ptr<BufferBudget> budget = basic_params.buffer_budget;
+  if (!budget) {
+    return create();
+  }
+  size_t accounted = 0;
+  std::shared_ptr<T> buffer(createAccounted(budget.get(), category, size, create, &accounted));
+  if (!buffer) {
+    return nullptr;
+  }
+  T* ptr = buffer.get();
+  return std::shared_ptr<T>(ptr, [buffer, budget, category, accounted](T*) mutable -> void {
+    buffer.reset();
+    budget->release(category, accounted);
+  });
+}
+
+std::shared_ptr<Buffer> createFixedSizeBuffer(const BasicParams &basic_params, size_t size, BufferCategory category) {
+  return accountFixedBuffer<Buffer>(basic_params, category, size, [&]() -> std::shared_ptr<Buffer> {
+    if (basic_params.buffer_pool) {
+      return basic_params.buffer_pool->createFixedSizeBuffer(size);
+    }
+    return createFixedSizeBuffer(size);
+  });
+}
+
+std::shared_ptr<Buffer> createExpandableBuffer(const BasicParams &basic_params, size_t initial_size, size_t expandable_size, BufferCategory category) {
+  if (expandable_size <= initial_size) {
+    return createFixedSizeBuffer(basic_params, initial_size, category);
+  }
+  return accountBuffer(basic_params, category, initial_size, [&]() -> std::shared_ptr<Buffer> {
+    if (basic_params.buffer_pool) {
+      return basic_params.buffer_pool->createExpandableBuffer(initial_size, expandable_size);
+    }
+    return createExpandableBuffer(initial_size, expandable_size);
+  });
+}
+
+std::shared_ptr<RingBuffer> createRingBuffer(const BasicParams &basic_params, size_t size, BufferCategory category) {
+  return accountFixedBuffer<RingBuffer>(basic_params, category, size, [&]() -> std::shared_ptr<RingBuffer> {
+    return createRingBuffer(size);
+  });
+}
+
+} // namespace unio
+} // namespace jcu
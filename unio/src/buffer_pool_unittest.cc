@@ -0,0 +1,119 @@
+/**
+ * @file	buffer_pool_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jcu-unio/buffer_pool.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+class BufferPoolTest : public ::testing::Test {
+};
+
+TEST_F(BufferPoolTest, ReuseReleasedBlock) {
+  auto pool = BufferPool::create();
+  const void* first_base;
+
+  {
+    auto buffer = pool->createFixedSizeBuffer(1000);
+    EXPECT_EQ(buffer->capacity(), 1000);
+    buffer->clear();
+    EXPECT_EQ(buffer->remaining(), 1000);
+    first_base = buffer->base();
+  }
+
+  auto buffer = pool->createFixedSizeBuffer(4096);
+  EXPECT_EQ(buffer->base(), first_base);
+
+  auto other = pool->createFixedSizeBuffer(4096);
+  EXPECT_NE(other->base(), first_base);
+}
+
+TEST_F(BufferPoolTest, SizeClasses) {
+  auto pool = BufferPool::create({1024, 8192}, 16384);
+
+  auto small = pool->createFixedSizeBuffer(100);
+  auto large = pool->createFixedSizeBuffer(8192);
+  auto huge = pool->createFixedSizeBuffer(100000);
+
+  EXPECT_EQ(small->capacity(), 100);
+  EXPECT_EQ(large->capacity(), 8192);
+  EXPECT_EQ(huge->capacity(), 100000);
+
+  huge->clear();
+  std::memset(huge->data(), 0xaa, huge->remaining());
+}
+
+TEST_F(BufferPoolTest, ExpandKeepsData) {
+  auto pool = BufferPool::create({1024, 8192}, 16384);
+  auto buffer = pool->createExpandableBuffer(512, 65536);
+
+  buffer->clear();
+  std::memset(buffer->data(), 'a', 512);
+
+  buffer->expand(1024);
+  EXPECT_EQ(buffer->capacity(), 1024);
+
+  buffer->expand(4096);
+  EXPECT_EQ(buffer->capacity(), 4096);
+  for (int i = 0; i < 512; i++) {
+    ASSERT_EQ(((const char*) buffer->base())[i], 'a');
+  }
+
+  buffer->expand(1000000);
+  EXPECT_EQ(buffer->capacity(), 65536);
+  for (int i = 0; i < 512; i++) {
+    ASSERT_EQ(((const char*) buffer->base())[i], 'a');
+  }
+}
+
+TEST_F(BufferPoolTest, TrimFreeSlabs) {
+  // 2 blocks per slab
+  auto pool = BufferPool::create({1024}, 2048);
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  for (int i = 0; i < 4; i++) {
+    buffers.emplace_back(pool->createFixedSizeBuffer(1024));
+  }
+  EXPECT_EQ(pool->trim(), 0);
+
+  // one block of each slab is in use
+  buffers.erase(buffers.begin() + 2);
+  buffers.erase(buffers.begin());
+  EXPECT_EQ(pool->trim(), 0);
+
+  buffers.clear();
+  EXPECT_EQ(pool->trim(), 4096);
+  EXPECT_EQ(pool->trim(), 0);
+
+  auto buffer = pool->createFixedSizeBuffer(1024);
+  EXPECT_EQ(buffer->capacity(), 1024);
+}
+
+TEST_F(BufferPoolTest, BasicParams) {
+  BasicParams basic_params;
+  auto heap_buffer = createFixedSizeBuffer(basic_params, 128);
+  EXPECT_EQ(heap_buffer->capacity(), 128);
+
+  basic_params.buffer_pool = BufferPool::create();
+  const void* base;
+  {
+    auto buffer = createFixedSizeBuffer(basic_params, 128);
+    base = buffer->base();
+  }
+  auto buffer = createExpandableBuffer(basic_params, 128, 256);
+  EXPECT_EQ(buffer->base(), base);
+  EXPECT_EQ(buffer->getExpandableSize(), 256);
+}
+
+}
@@ -0,0 +1,421 @@
+/**
+ * @file	buffer_scan.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define JCU_UNIO_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define JCU_UNIO_TARGET_SSE2 __attribute__((target("sse2")))
+#define JCU_UNIO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JCU_UNIO_TARGET_SSE2
+#define JCU_UNIO_TARGET_AVX2
+#endif
+
+#include <jcu-unio/buffer_scan.h>
+
+#include "buffer_scan_impl.h"
+
+namespace jcu {
+namespace unio {
+namespace scan {
+
+namespace {
+
+/**
+ * scalar implementations also finish the tail of the vectorized ones
+ */
+
+size_t scalarFindByte(const uint8_t* data, size_t size, size_t start, uint8_t value) {
+  if (start >= size) {
+    return kScanNotFound;
+  }
+  const void* found = std::memchr(data + start, value, size - start);
+  return found ? ((const uint8_t*) found - data) : kScanNotFound;
+}
+
+size_t scalarFindAnyOf(const uint8_t* data, size_t size, size_t start, const uint8_t* set, size_t set_size) {
+  bool table[256] = {false};
+  for (size_t i = 0; i < set_size; i++) {
+    table[set[i]] = true;
+  }
+  for (size_t i = start; i < size; i++) {
+    if (table[data[i]]) {
+      return i;
+    }
+  }
+  return kScanNotFound;
+}
+
+size_t scalarFindCrlfCrlf(const uint8_t* data, size_t size, size_t start) {
+  size_t i = start;
+  while (size >= 4 && i <= size - 4) {
+    i = scalarFindByte(data, size - 3, i, '\r');
+    if (i == kScanNotFound) {
+      break;
+    }
+    if (data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+      return i;
+    }
+    i++;
+  }
+  return kScanNotFound;
+}
+
+size_t scalarCountNewlines(const uint8_t* data, size_t size, size_t start) {
+  size_t count = 0;
+  for (size_t i = start; i < size; i++) {
+    count += (data[i] == '\n');
+  }
+  return count;
+}
+
+size_t scalarFindByte(const uint8_t* data, size_t size, uint8_t value) {
+  return scalarFindByte(data, size, 0, value);
+}
+
+size_t scalarFindAnyOf(const uint8_t* data, size_t size, const uint8_t* set, size_t set_size) {
+  return scalarFindAnyOf(data, size, 0, set, set_size);
+}
+
+size_t scalarFindCrlfCrlf(const uint8_t* data, size_t size) {
+  return scalarFindCrlfCrlf(data, size, 0);
+}
+
+size_t scalarCountNewlines(const uint8_t* data, size_t size) {
+  return scalarCountNewlines(data, size, 0);
+}
+
+const ScanFunctions kScalarFunctions = {
+    "scalar",
+    scalarFindByte,
+    scalarFindAnyOf,
+    scalarFindCrlfCrlf,
+    scalarCountNewlines
+};
+
+#if defined(JCU_UNIO_SCAN_X86)
+
+/**
+ * Maximum set size of the vectorized findAnyOf
+ */
+const size_t kMaxVectorSetSize = 16;
+
+inline unsigned int countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int) index;
+#else
+  return (unsigned int) __builtin_ctz(mask);
+#endif
+}
+
+JCU_UNIO_TARGET_SSE2
+size_t sse2FindByte(const uint8_t* data, size_t size, uint8_t value) {
+  const __m128i needle = _mm_set1_epi8((char) value);
+  size_t i = 0;
+  // 64 bytes per iteration while there is no match
+  for (; i + 64 <= size; i += 64) {
+    __m128i m0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i)), needle);
+    __m128i m1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i + 16)), needle);
+    __m128i m2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i + 32)), needle);
+    __m128i m3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i + 48)), needle);
+    __m128i any = _mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3));
+    if (_mm_movemask_epi8(any)) {
+      break;
+    }
+  }
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindByte(data, size, i, value);
+}
+
+JCU_UNIO_TARGET_SSE2
+size_t sse2FindAnyOf(const uint8_t* data, size_t size, const uint8_t* set, size_t set_size) {
+  if (set_size > kMaxVectorSetSize) {
+    return scalarFindAnyOf(data, size, 0, set, set_size);
+  }
+  __m128i needles[kMaxVectorSetSize];
+  for (size_t j = 0; j < set_size; j++) {
+    needles[j] = _mm_set1_epi8((char) set[j]);
+  }
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+    __m128i matches = _mm_setzero_si128();
+    for (size_t j = 0; j < set_size; j++) {
+      matches = _mm_or_si128(matches, _mm_cmpeq_epi8(v, needles[j]));
+    }
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(matches);
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindAnyOf(data, size, i, set, set_size);
+}
+
+JCU_UNIO_TARGET_SSE2
+size_t sse2FindCrlfCrlf(const uint8_t* data, size_t size) {
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  size_t i = 0;
+  // compare the 4 shifted windows at once
+  for (; i + 16 + 3 <= size; i += 16) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*) (data + i));
+    __m128i v1 = _mm_loadu_si128((const __m128i*) (data + i + 1));
+    __m128i v2 = _mm_loadu_si128((const __m128i*) (data + i + 2));
+    __m128i v3 = _mm_loadu_si128((const __m128i*) (data + i + 3));
+    __m128i matches = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi8(v0, cr), _mm_cmpeq_epi8(v1, lf)),
+        _mm_and_si128(_mm_cmpeq_epi8(v2, cr), _mm_cmpeq_epi8(v3, lf))
+    );
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(matches);
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindCrlfCrlf(data, size, i);
+}
+
+JCU_UNIO_TARGET_SSE2
+size_t sse2CountNewlines(const uint8_t* data, size_t size) {
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i zero = _mm_setzero_si128();
+  size_t count = 0;
+  size_t i = 0;
+  while (size - i >= 16) {
+    // byte counters overflow after 255 blocks
+    size_t blocks = (size - i) / 16;
+    if (blocks > 255) blocks = 255;
+    __m128i counters = _mm_setzero_si128();
+    for (size_t b = 0; b < blocks; b++, i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+      counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(v, lf));
+    }
+    uint64_t sums[2];
+    _mm_storeu_si128((__m128i*) sums, _mm_sad_epu8(counters, zero));
+    count += (size_t) (sums[0] + sums[1]);
+  }
+  return count + scalarCountNewlines(data, size, i);
+}
+
+JCU_UNIO_TARGET_AVX2
+size_t avx2FindByte(const uint8_t* data, size_t size, uint8_t value) {
+  const __m256i needle = _mm256_set1_epi8((char) value);
+  size_t i = 0;
+  // 128 bytes per iteration while there is no match
+  for (; i + 128 <= size; i += 128) {
+    __m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i)), needle);
+    __m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i + 32)), needle);
+    __m256i m2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i + 64)), needle);
+    __m256i m3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i + 96)), needle);
+    __m256i any = _mm256_or_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m2, m3));
+    if (_mm256_movemask_epi8(any)) {
+      break;
+    }
+  }
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindByte(data, size, i, value);
+}
+
+JCU_UNIO_TARGET_AVX2
+size_t avx2FindAnyOf(const uint8_t* data, size_t size, const uint8_t* set, size_t set_size) {
+  if (set_size > kMaxVectorSetSize) {
+    return scalarFindAnyOf(data, size, 0, set, set_size);
+  }
+  __m256i needles[kMaxVectorSetSize];
+  for (size_t j = 0; j < set_size; j++) {
+    needles[j] = _mm256_set1_epi8((char) set[j]);
+  }
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+    __m256i matches = _mm256_setzero_si256();
+    for (size_t j = 0; j < set_size; j++) {
+      matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(v, needles[j]));
+    }
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(matches);
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindAnyOf(data, size, i, set, set_size);
+}
+
+JCU_UNIO_TARGET_AVX2
+size_t avx2FindCrlfCrlf(const uint8_t* data, size_t size) {
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  size_t i = 0;
+  for (; i + 32 + 3 <= size; i += 32) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i*) (data + i));
+    __m256i v1 = _mm256_loadu_si256((const __m256i*) (data + i + 1));
+    __m256i v2 = _mm256_loadu_si256((const __m256i*) (data + i + 2));
+    __m256i v3 = _mm256_loadu_si256((const __m256i*) (data + i + 3));
+    __m256i matches = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpeq_epi8(v0, cr), _mm256_cmpeq_epi8(v1, lf)),
+        _mm256_and_si256(_mm256_cmpeq_epi8(v2, cr), _mm256_cmpeq_epi8(v3, lf))
+    );
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(matches);
+    if (mask) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+  return scalarFindCrlfCrlf(data, size, i);
+}
+
+JCU_UNIO_TARGET_AVX2
+size_t avx2CountNewlines(const uint8_t* data, size_t size) {
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i zero = _mm256_setzero_si256();
+  size_t count = 0;
+  size_t i = 0;
+  while (size - i >= 32) {
+    size_t blocks = (size - i) / 32;
+    if (blocks > 255) blocks = 255;
+    __m256i counters = _mm256_setzero_si256();
+    for (size_t b = 0; b < blocks; b++, i += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+      counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(v, lf));
+    }
+    uint64_t sums[4];
+    _mm256_storeu_si256((__m256i*) sums, _mm256_sad_epu8(counters, zero));
+    count += (size_t) (sums[0] + sums[1] + sums[2] + sums[3]);
+  }
+  return count + scalarCountNewlines(data, size, i);
+}
+
+const ScanFunctions kSse2Functions = {
+    "sse2",
+    sse2FindByte,
+    sse2FindAnyOf,
+    sse2FindCrlfCrlf,
+    sse2CountNewlines
+};
+
+const ScanFunctions kAvx2Functions = {
+    "avx2",
+    avx2FindByte,
+    avx2FindAnyOf,
+    avx2FindCrlfCrlf,
+    avx2CountNewlines
+};
+
+bool cpuSupportsSse2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // the OS must save the YMM registers (OSXSAVE + XCR0)
+  if (!(info[2] & (1 << 27)) || ((_xgetbv(0) & 0x6) != 0x6)) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+const ScanFunctions* selectScanFunctions() {
+  const ScanFunctions* functions = getAvx2Functions();
+  if (!functions) functions = getSse2Functions();
+  if (!functions) functions = getScalarFunctions();
+  return functions;
+}
+
+} // namespace
+
+const ScanFunctions* getScalarFunctions() {
+  return &kScalarFunctions;
+}
+
+const ScanFunctions* getSse2Functions() {
+#if defined(JCU_UNIO_SCAN_X86)
+  static const bool supported = cpuSupportsSse2();
+  return supported ? &kSse2Functions : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+const ScanFunctions* getAvx2Functions() {
+#if defined(JCU_UNIO_SCAN_X86)
+  static const bool supported = cpuSupportsAvx2();
+  return supported ? &kAvx2Functions : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+const ScanFunctions* getScanFunctions() {
+  static const ScanFunctions* functions = selectScanFunctions();
+  return functions;
+}
+
+} // namespace scan
+
+size_t findByte(const void* data, size_t size, uint8_t value) {
+  return scan::getScanFunctions()->find_byte((const uint8_t*) data, size, value);
+}
+
+size_t findAnyOf(const void* data, size_t size, const void* set, size_t set_size) {
+  return scan::getScanFunctions()->find_any_of((const uint8_t*) data, size, (const uint8_t*) set, set_size);
+}
+
+size_t findCrlfCrlf(const void* data, size_t size) {
+  return scan::getScanFunctions()->find_crlf_crlf((const uint8_t*) data, size);
+}
+
+size_t countNewlines(const void* data, size_t size) {
+  return scan::getScanFunctions()->count_newlines((const uint8_t*) data, size);
+}
+
+const char* getScanImplementation() {
+  return scan::getScanFunctions()->name;
+}
+
+} // namespace unio
+} // namespace jcu
@@ -0,0 +1,49 @@
+/**
+ * @file	buffer_scan_impl.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_SRC_BUFFER_SCAN_IMPL_H_
+#define JCU_UNIO_SRC_BUFFER_SCAN_IMPL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace jcu {
+namespace unio {
+namespace scan {
+
+struct ScanFunctions {
+  const char* name;
+  size_t (*find_byte)(const uint8_t* data, size_t size, uint8_t value);
+  size_t (*find_any_of)(const uint8_t* data, size_t size, const uint8_t* set, size_t set_size);
+  size_t (*find_crlf_crlf)(const uint8_t* data, size_t size);
+  size_t (*count_newlines)(const uint8_t* data, size_t size);
+};
+
+const ScanFunctions* getScalarFunctions();
+
+/**
+ * @return nullptr if it is not supported by the compiler or the CPU
+ */
+const ScanFunctions* getSse2Functions();
+
+/**
+ * @return nullptr if it is not supported by the compiler or the CPU
+ */
+const ScanFunctions* getAvx2Functions();
+
+/**
+ * functions selected for this CPU
+ */
+const ScanFunctions* getScanFunctions();
+
+} // namespace scan
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_SRC_BUFFER_SCAN_IMPL_H_
@@ -0,0 +1,114 @@
+/**
+ * @file	buffer_scan_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <jcu-unio/buffer_scan.h>
+
+#include "buffer_scan_impl.h"
+
+namespace {
+
+using namespace jcu::unio;
+
+class BufferScanTest : public ::testing::Test {
+ public:
+  /**
+   * every implementation this CPU supports
+   */
+  static std::vector<const scan::ScanFunctions*> implementations() {
+    std::vector<const scan::ScanFunctions*> result;
+    result.push_back(scan::getScalarFunctions());
+    if (scan::getSse2Functions()) result.push_back(scan::getSse2Functions());
+    if (scan::getAvx2Functions()) result.push_back(scan::getAvx2Functions());
+    return result;
+  }
+
+  static size_t naiveFindCrlfCrlf(const std::string& text) {
+    size_t pos = text.find("\r\n\r\n");
+    return (pos == std::string::npos) ? kScanNotFound : pos;
+  }
+
+  static size_t naiveFindAnyOf(const std::string& text, const std::string& set) {
+    size_t pos = text.find_first_of(set);
+    return (pos == std::string::npos) ? kScanNotFound : pos;
+  }
+};
+
+TEST_F(BufferScanTest, CompareWithNaive) {
+  std::mt19937 random(1234);
+  const char alphabet[] = "ab\r\n:;";
+  for (const auto* functions : implementations()) {
+    SCOPED_TRACE(functions->name);
+    for (size_t size = 0; size < 300; size++) {
+      std::string text;
+      for (size_t i = 0; i < size; i++) {
+        // mostly 'a' so that matches land in the vectorized body and the tail
+        text.push_back((random() % 8) ? 'a' : alphabet[random() % (sizeof(alphabet) - 1)]);
+      }
+      const uint8_t* data = (const uint8_t*) text.data();
+
+      size_t lf = text.find('\n');
+      EXPECT_EQ(functions->find_byte(data, size, '\n'), (lf == std::string::npos) ? kScanNotFound : lf);
+      EXPECT_EQ(functions->find_any_of(data, size, (const uint8_t*) ":;", 2), naiveFindAnyOf(text, ":;"));
+      EXPECT_EQ(functions->find_crlf_crlf(data, size), naiveFindCrlfCrlf(text));
+      EXPECT_EQ(functions->count_newlines(data, size), (size_t) std::count(text.begin(), text.end(), '\n'));
+    }
+  }
+}
+
+TEST_F(BufferScanTest, LargeInput) {
+  std::string text(100000, 'x');
+  text[70001] = '\n';
+  text[99990] = '\n';
+  text.replace(90000, 4, "\r\n\r\n");
+  std::string set;
+  for (int i = 0; i < 20; i++) {
+    set.push_back((char) ('A' + i));
+  }
+  text[80000] = 'T';
+
+  for (const auto* functions : implementations()) {
+    SCOPED_TRACE(functions->name);
+    const uint8_t* data = (const uint8_t*) text.data();
+    EXPECT_EQ(functions->find_byte(data, text.size(), '\n'), 70001);
+    EXPECT_EQ(functions->find_any_of(data, text.size(), (const uint8_t*) "\r\n", 2), 70001);
+    // more than 16 bytes uses the scalar path
+    EXPECT_EQ(functions->find_any_of(data, text.size(), (const uint8_t*) set.data(), set.size()), 80000);
+    EXPECT_EQ(functions->find_crlf_crlf(data, text.size()), 90000);
+    EXPECT_EQ(functions->count_newlines(data, text.size()), 4);
+  }
+}
+
+TEST_F(BufferScanTest, BufferAndSlice) {
+  const char request[] = "GET / HTTP/1.1\r\nHost: a\r\n\r\nbody";
+  auto buffer = createFixedSizeBuffer(sizeof(request) - 1);
+  buffer->clear();
+  std::memcpy(buffer->data(), request, sizeof(request) - 1);
+  buffer->position(4);
+
+  EXPECT_EQ(findByte(*buffer, '\n'), 11);
+  EXPECT_EQ(findAnyOf(*buffer, ":/", 2), 0);
+  EXPECT_EQ(findCrlfCrlf(*buffer), 19);
+  EXPECT_EQ(countNewlines(*buffer), 3);
+  EXPECT_EQ(findByte(*buffer, '#'), kScanNotFound);
+
+  BufferSlice slice(buffer);
+  EXPECT_EQ(findCrlfCrlf(slice.slice(22, 100)), kScanNotFound);
+  EXPECT_EQ(countNewlines(slice.slice(0, 13)), 1);
+  EXPECT_NE(getScanImplementation(), nullptr);
+}
+
+}
@@ -9,6 +9,8 @@
 
 #include <string>
 #include <atomic>
+#include <cstring>
+#include <cstdio>
 
 #include <gtest/gtest.h>
 
@@ -49,4 +51,200 @@ TEST_F(BufferTest, PositionTest) {
   EXPECT_EQ(buffer->remaining(), 512 - 128);
 }
 
+TEST_F(BufferTest, UninitializedExpand) {
+  BufferOptions options;
+  options.zero_fill = false;
+  auto buffer = createExpandableBuffer(16, 1024, options);
+  EXPECT_EQ(buffer->capacity(), 16);
+  EXPECT_EQ(buffer->getExpandableSize(), 1024);
+
+  buffer->clear();
+  std::memcpy(buffer->data(), "0123456789abcdef", 16);
+
+  buffer->expand(100);
+  EXPECT_EQ(buffer->capacity(), 100);
+  EXPECT_EQ(std::memcmp(buffer->base(), "0123456789abcdef", 16), 0);
+
+  buffer->expand(4096);
+  EXPECT_EQ(buffer->capacity(), 1024);
+  EXPECT_EQ(std::memcmp(buffer->base(), "0123456789abcdef", 16), 0);
+
+  buffer->clear();
+  EXPECT_EQ(buffer->remaining(), 1024);
+}
+
+TEST_F(BufferTest, Reserve) {
+  BufferOptions options;
+  options.zero_fill = false;
+  auto buffer = createExpandableBuffer(16, 65536, options);
+
+  buffer->reserve(8192);
+  EXPECT_EQ(buffer->capacity(), 16);
+
+  const void* base = buffer->base();
+  buffer->expand(4096);
+  buffer->expand(8192);
+  EXPECT_EQ(buffer->capacity(), 8192);
+  EXPECT_EQ(buffer->base(), base);
+}
+
+TEST_F(BufferTest, FlatBuffer) {
+  auto buffer = createExpandableBuffer(16, 1024);
+  FlatBuffer* flat_buffer = FlatBuffer::from(buffer.get());
+  ASSERT_NE(flat_buffer, nullptr);
+
+  flat_buffer->clear();
+  std::memset(flat_buffer->data(), 0xff, flat_buffer->remaining());
+  flat_buffer->expand(512);
+  EXPECT_EQ(buffer->capacity(), 512);
+  for (size_t i = 16; i < 512; i++) {
+    ASSERT_EQ(((const char*) buffer->base())[i], 0);
+  }
+
+  size_t visited = visitBuffer(buffer.get(), [](auto* buffer) -> size_t {
+    return buffer->capacity();
+  });
+  EXPECT_EQ(visited, 512);
+
+  auto slice = BufferSlice(buffer).asBuffer();
+  EXPECT_EQ(FlatBuffer::from(slice.get()), nullptr);
+  EXPECT_EQ(FlatBuffer::from(nullptr), nullptr);
+}
+
+TEST_F(BufferTest, AlignedExpand) {
+  BufferOptions options;
+  options.alignment = 4096;
+  auto buffer = createExpandableBuffer(100, 65536, options);
+  EXPECT_EQ(((uintptr_t) buffer->base()) % 4096, 0);
+
+  buffer->clear();
+  std::memcpy(buffer->data(), "0123456789abcdef", 16);
+  buffer->expand(30000);
+  EXPECT_EQ(buffer->capacity(), 30000);
+  EXPECT_EQ(((uintptr_t) buffer->base()) % 4096, 0);
+  EXPECT_EQ(std::memcmp(buffer->base(), "0123456789abcdef", 16), 0);
+  EXPECT_EQ(((const char*) buffer->base())[29999], 0);
+
+  options.alignment = 64;
+  auto small = createFixedSizeBuffer(10, options);
+  EXPECT_EQ(((uintptr_t) small->base()) % 64, 0);
+}
+
+TEST_F(BufferTest, HugePages) {
+  BufferOptions options;
+  options.zero_fill = false;
+  options.huge_pages = true;
+  auto buffer = createExpandableBuffer(FlatBuffer::kHugePageSize, 4 * FlatBuffer::kHugePageSize, options);
+  ASSERT_NE(buffer->base(), nullptr);
+  buffer->clear();
+  std::memset(buffer->data(), 'a', buffer->remaining());
+
+  buffer->expand(3 * FlatBuffer::kHugePageSize);
+  EXPECT_EQ(buffer->capacity(), 3 * FlatBuffer::kHugePageSize);
+  EXPECT_EQ(((const char*) buffer->base())[FlatBuffer::kHugePageSize - 1], 'a');
+  buffer->clear();
+  std::memset(buffer->data(), 'b', buffer->remaining());
+}
+
+TEST_F(BufferTest, RingBufferMirror) {
+  auto buffer = createRingBuffer(1000);
+#if defined(__linux__)
+  ASSERT_NE(buffer, nullptr);
+  size_t size = buffer->capacity();
+  EXPECT_GE(size, 1000);
+  EXPECT_EQ(buffer->writable(), size);
+
+  // move the read/write offsets close to the end
+  buffer->commit(size - 4);
+  buffer->position(size - 4);
+  EXPECT_EQ(buffer->remaining(), 0);
+  EXPECT_EQ(buffer->writable(), size);
+
+  // write across the end of the storage
+  std::memcpy(buffer->writableData(), "0123456789", 10);
+  buffer->commit(10);
+  EXPECT_EQ(buffer->remaining(), 10);
+  EXPECT_EQ(std::memcmp(buffer->data(), "0123456789", 10), 0);
+  EXPECT_EQ(std::memcmp(buffer->base(), "456789", 6), 0);
+
+  // consuming across the end wraps the offsets
+  buffer->position(buffer->position() + 8);
+  EXPECT_EQ(buffer->position(), 4);
+  EXPECT_EQ(buffer->remaining(), 2);
+  EXPECT_EQ(std::memcmp(buffer->data(), "89", 2), 0);
+  EXPECT_EQ(buffer->writable(), size - 2);
+
+  buffer->clear();
+  EXPECT_EQ(buffer->remaining(), 0);
+  EXPECT_EQ(buffer->data(), buffer->base());
+#else
+  EXPECT_EQ(buffer, nullptr);
+#endif
+}
+
+TEST_F(BufferTest, Slice) {
+  auto buffer = createFixedSizeBuffer(16);
+  std::memcpy(buffer->data(), "0123456789", 10);
+  buffer->position(10);
+  buffer->flip();
+  buffer->position(2);
+
+  BufferSlice slice(buffer);
+  EXPECT_EQ(slice.size(), 8);
+  EXPECT_EQ(std::memcmp(slice.data(), "23456789", 8), 0);
+  EXPECT_EQ(buffer.use_count(), 2);
+
+  BufferSlice sub = slice.slice(4, 100);
+  EXPECT_EQ(sub.size(), 4);
+  EXPECT_EQ(std::memcmp(sub.data(), "6789", 4), 0);
+
+  std::weak_ptr<Buffer> weak_buffer = buffer;
+  buffer.reset();
+  slice = BufferSlice();
+  EXPECT_FALSE(weak_buffer.expired());
+
+  auto view = sub.asBuffer();
+  EXPECT_EQ(view->remaining(), 4);
+  EXPECT_EQ(std::memcmp(view->data(), "6789", 4), 0);
+  sub = BufferSlice();
+  EXPECT_FALSE(weak_buffer.expired());
+  view.reset();
+  EXPECT_TRUE(weak_buffer.expired());
+}
+
+TEST_F(BufferTest, MappedFile) {
+  const char* path = "jcu_unio_mapped_file_test.bin";
+  std::string content;
+  for (int i = 0; content.size() < 10000; i++) {
+    content += std::to_string(i) + ",";
+  }
+  FILE* fp = fopen(path, "wb");
+  ASSERT_NE(fp, nullptr);
+  fwrite(content.data(), 1, content.size(), fp);
+  fclose(fp);
+
+#if !defined(_WIN32)
+  auto whole = createMappedFileBuffer(path);
+  ASSERT_NE(whole, nullptr);
+  EXPECT_EQ(whole->position(), 0);
+  EXPECT_EQ(whole->remaining(), content.size());
+  EXPECT_EQ(std::memcmp(whole->data(), content.data(), content.size()), 0);
+
+  // not page aligned
+  auto region = createMappedFileBuffer(path, 5000, 100);
+  ASSERT_NE(region, nullptr);
+  EXPECT_EQ(region->remaining(), 100);
+  EXPECT_EQ(std::memcmp(region->data(), content.data() + 5000, 100), 0);
+
+  auto tail = createMappedFileBuffer(path, 9000, 100000);
+  ASSERT_NE(tail, nullptr);
+  EXPECT_EQ(tail->remaining(), content.size() - 9000);
+
+  EXPECT_EQ(createMappedFileBuffer(path, content.size()), nullptr);
+#endif
+  EXPECT_EQ(createMappedFileBuffer("jcu_unio_not_exists.bin"), nullptr);
+
+  std::remove(path);
+}
+
 }
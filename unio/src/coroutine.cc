@@ -0,0 +1,95 @@
+/**
+ * @file	coroutine.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <new>
+
+#include <jcu-unio/coroutine.h>
+
+namespace jcu {
+namespace unio {
+
+namespace {
+
+/**
+ * Free frames of the thread, by 64 bytes size classes
+ */
+class CoroutineFrameCache {
+ public:
+  static const size_t kClassSize = 64;
+  static const size_t kClassCount = 16;
+  static const size_t kMaxFreeFrames = 64;
+
+  ~CoroutineFrameCache() {
+    for (size_t i = 0; i < kClassCount; i++) {
+      FreeFrame* frame = free_[i];
+      while (frame) {
+        FreeFrame* next = frame->next;
+        ::operator delete(frame);
+        frame = next;
+      }
+    }
+  }
+
+  static size_t getClass(size_t size) {
+    return (size + kClassSize - 1) / kClassSize - 1;
+  }
+
+  void* acquire(size_t index) {
+    FreeFrame* frame = free_[index];
+    if (frame) {
+      free_[index] = frame->next;
+      count_[index]--;
+      return frame;
+    }
+    return ::operator new((index + 1) * kClassSize);
+  }
+
+  void release(void* ptr, size_t index) {
+    if (count_[index] >= kMaxFreeFrames) {
+      ::operator delete(ptr);
+      return ;
+    }
+    FreeFrame* frame = static_cast<FreeFrame*>(ptr);
+    frame->next = free_[index];
+    free_[index] = frame;
+    count_[index]++;
+  }
+
+ private:
+  struct FreeFrame {
+    FreeFrame* next;
+  };
+
+  FreeFrame* free_[kClassCount] = {};
+  size_t count_[kClassCount] = {};
+};
+
+thread_local CoroutineFrameCache frame_cache;
+
+} // namespace
+
+void* allocateCoroutineFrame(size_t size) {
+  size_t index = CoroutineFrameCache::getClass(size);
+  if (index >= CoroutineFrameCache::kClassCount) {
+    return ::operator new(size);
+  }
+  return frame_cache.acquire(index);
+}
+
+void freeCoroutineFrame(void* ptr, size_t size) {
+  size_t index = CoroutineFrameCache::getClass(size);
+  if (index >= CoroutineFrameCache::kClassCount) {
+    ::operator delete(ptr);
+    return ;
+  }
+  frame_cache.release(ptr, index);
+}
+
+} // namespace unio
+} // namespace jcu
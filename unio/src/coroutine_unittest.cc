@@ -0,0 +1,143 @@
+/**
+ * @file	coroutine_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "../test/unit_test_utils.h"
+#include <jcu-unio/coroutine.h>
+#include <jcu-unio/loop_group.h>
+
+#if defined(JCU_UNIO_HAS_COROUTINE)
+
+#include <optional>
+
+namespace {
+
+using namespace jcu::unio;
+
+class CoroutineTest : public LoopSupportTest {
+};
+
+Task<std::thread::id> getThreadOn(std::shared_ptr<Loop> loop) {
+  co_await loop->schedule();
+  co_return std::this_thread::get_id();
+}
+
+Task<> hopAndReport(std::shared_ptr<Loop> loop, std::promise<bool>& result) {
+  std::thread::id id = co_await getThreadOn(loop);
+  result.set_value((id != std::this_thread::get_id()) || loop->isInLoopThread());
+}
+
+TEST_F(CoroutineTest, Schedule) {
+  auto loop = basic_params_.loop;
+  std::promise<bool> p_done;
+  std::future<bool> f_done = p_done.get_future();
+
+  // no loop on this thread: continues where the task completes
+  hopAndReport(loop, p_done).detach();
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_TRUE(f_done.get());
+}
+
+Task<> awaitOnOtherLoop(std::shared_ptr<Loop> home, std::shared_ptr<Loop> other, std::promise<int>& result) {
+  co_await home->schedule();
+  std::thread::id home_id = std::this_thread::get_id();
+  std::thread::id other_id = co_await getThreadOn(other);
+  int ok = (other_id != home_id) && (std::this_thread::get_id() == home_id) && home->isInLoopThread();
+  result.set_value(ok);
+}
+
+TEST_F(CoroutineTest, ResumeOnAwaitingLoop) {
+  LoopGroupOptions options;
+  options.threads = 2;
+  auto group = LoopGroup::create(options);
+  group->start();
+
+  std::promise<int> p_done;
+  std::future<int> f_done = p_done.get_future();
+  awaitOnOtherLoop(group->getLoop(0), group->getLoop(1), p_done).detach();
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(f_done.get(), 1);
+
+  group->stop();
+  group->join();
+}
+
+Task<int> addOne(int value) {
+  co_return value + 1;
+}
+
+Task<int> addTwo(int value) {
+  int result = co_await addOne(value);
+  co_return co_await addOne(result);
+}
+
+Task<> throwError() {
+  throw std::runtime_error("error");
+  co_return;
+}
+
+Task<bool> catchError() {
+  try {
+    co_await throwError();
+  } catch (const std::runtime_error& e) {
+    co_return true;
+  }
+  co_return false;
+}
+
+Task<bool> awaitEmptyTask() {
+  Task<int> task(addOne(1));
+  Task<int> moved(std::move(task));
+  bool thrown = false;
+  try {
+    co_await task;
+  } catch (const std::logic_error& e) {
+    thrown = true;
+  }
+  co_return thrown && ((co_await moved) == 2);
+}
+
+template<typename T>
+Task<> storeResult(Task<T> task, std::optional<T>* result) {
+  *result = co_await std::move(task);
+}
+
+template<typename T>
+static T runSync(Task<T> task) {
+  std::optional<T> result;
+  storeResult(std::move(task), &result).detach();
+  return *result;
+}
+
+TEST(CoroutineFrameTest, NestedTasks) {
+  EXPECT_EQ(runSync(addTwo(1)), 3);
+  EXPECT_TRUE(runSync(catchError()));
+  EXPECT_TRUE(runSync(awaitEmptyTask()));
+}
+
+TEST(CoroutineFrameTest, FramesArePooled) {
+  int sum = 0;
+  for (int i = 0; i < 10; i++) {
+    sum += runSync(addTwo(i));
+  }
+
+  size_t before = getAllocationCount();
+  for (int i = 0; i < 1000; i++) {
+    sum += runSync(addTwo(i));
+  }
+  EXPECT_EQ(getAllocationCount() - before, 0);
+  EXPECT_GT(sum, 0);
+}
+
+} // namespace
+
+#endif // JCU_UNIO_HAS_COROUTINE
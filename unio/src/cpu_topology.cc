@@ -0,0 +1,218 @@
+/**
+ * @file	cpu_topology.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <thread>
+
+#include <uv.h>
+
+#include <jcu-unio/cpu_topology.h>
+
+namespace jcu {
+namespace unio {
+
+#if defined(__linux__)
+static bool readSysFile(const std::string& path, std::string& out) {
+  FILE* fp = fopen(path.c_str(), "r");
+  if (!fp) {
+    return false;
+  }
+  char buf[1024];
+  out.clear();
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    out.append(buf, n);
+  }
+  fclose(fp);
+  return true;
+}
+
+/**
+ * parse "0-3,8,10-11"
+ */
+static std::vector<int> parseCpuList(const std::string& text) {
+  std::vector<int> list;
+  const char* p = text.c_str();
+  while (*p) {
+    char* end;
+    long first = strtol(p, &end, 10);
+    if (end == p) {
+      break;
+    }
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      p++;
+      last = strtol(p, &end, 10);
+      if (end == p) {
+        break;
+      }
+      p = end;
+    }
+    for (long i = first; i <= last; i++) {
+      list.push_back((int) i);
+    }
+    if (*p != ',') {
+      break;
+    }
+    p++;
+  }
+  return list;
+}
+#endif
+
+CpuTopology CpuTopology::detect() {
+  CpuTopology topology;
+#if defined(__linux__)
+  std::string text;
+  if (readSysFile("/sys/devices/system/cpu/online", text)) {
+    topology.cpus = parseCpuList(text);
+  }
+  topology.cpu_nodes.assign(topology.cpus.size(), 0);
+  std::vector<int> nodes;
+  if (readSysFile("/sys/devices/system/node/online", text)) {
+    nodes = parseCpuList(text);
+  }
+  for (int node : nodes) {
+    if (!readSysFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", text)) {
+      continue;
+    }
+    bool has_cpu = false;
+    for (int cpu : parseCpuList(text)) {
+      auto it = std::find(topology.cpus.begin(), topology.cpus.end(), cpu);
+      if (it != topology.cpus.end()) {
+        topology.cpu_nodes[it - topology.cpus.begin()] = node;
+        has_cpu = true;
+      }
+    }
+    if (has_cpu) {
+      topology.nodes.push_back(node);
+    }
+  }
+#endif
+  if (topology.cpus.empty()) {
+    unsigned int count = std::thread::hardware_concurrency();
+    for (unsigned int i = 0; i < std::max(count, 1U); i++) {
+      topology.cpus.push_back((int) i);
+    }
+    topology.cpu_nodes.assign(topology.cpus.size(), 0);
+  }
+  if (topology.nodes.empty()) {
+    topology.nodes.push_back(0);
+    topology.cpu_nodes.assign(topology.cpus.size(), 0);
+  }
+  return topology;
+}
+
+int CpuTopology::getNumaNode(int cpu) const {
+  for (size_t i = 0; i < cpus.size(); i++) {
+    if (cpus[i] == cpu) {
+      return cpu_nodes[i];
+    }
+  }
+  return -1;
+}
+
+std::vector<int> CpuTopology::getNodeCpus(int node) const {
+  std::vector<int> list;
+  for (size_t i = 0; i < cpus.size(); i++) {
+    if (cpu_nodes[i] == node) {
+      list.push_back(cpus[i]);
+    }
+  }
+  return list;
+}
+
+int getCurrentCpu() {
+#if defined(__linux__)
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+int setThreadAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return UV_EINVAL;
+    }
+    CPU_SET(cpu, &set);
+  }
+  int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  return rc ? -rc : 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+int setThreadNumaMemory(int node, NumaMemoryPolicy policy) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  // from <numaif.h>, so that libnuma is not needed
+  static const int kMpolDefault = 0;
+  static const int kMpolPreferred = 1;
+  static const int kMpolBind = 2;
+
+  unsigned long mask[16] = { 0 };
+  const int bits = (int) (sizeof(mask[0]) * 8);
+  if (policy == kNumaMemoryDefault) {
+    return (syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0) == 0) ? 0 : -errno;
+  }
+  if (node < 0 || node >= (int) (sizeof(mask) * 8)) {
+    return UV_EINVAL;
+  }
+  mask[node / bits] |= 1UL << (node % bits);
+  int mode = (policy == kNumaMemoryBindLocal) ? kMpolBind : kMpolPreferred;
+  // the kernel takes one more than the number of bits
+  return (syscall(SYS_set_mempolicy, mode, mask, sizeof(mask) * 8 + 1) == 0) ? 0 : -errno;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+  std::vector<int> sorted(cpus);
+  std::sort(sorted.begin(), sorted.end());
+  std::string text;
+  size_t i = 0;
+  while (i < sorted.size()) {
+    size_t j = i;
+    while ((j + 1 < sorted.size()) && (sorted[j + 1] == sorted[j] + 1)) {
+      j++;
+    }
+    if (!text.empty()) {
+      text += ",";
+    }
+    text += std::to_string(sorted[i]);
+    if (j > i) {
+      text += "-" + std::to_string(sorted[j]);
+    }
+    i = j + 1;
+  }
+  return text;
+}
+
+} // namespace unio
+} // namespace jcu
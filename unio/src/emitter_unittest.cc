@@ -11,6 +11,7 @@
 #include <atomic>
 #include <thread>
 #include <future>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -273,6 +274,136 @@ TEST_F(EmitterTest, InheritedEventOn) {
   EXPECT_EQ(sobj_d.use_count(), 1);
 }
 
+TEST_F(EmitterTest, ChangeListenersDuringCall) {
+  std::shared_ptr<TestObject> instance(TestObject::create(basic_params_));
+  std::vector<int> calls;
+
+  instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(1);
+    // called from the next emit
+    instance->once<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+      calls.push_back(3);
+    });
+  });
+  instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(2);
+    instance->off<AlphaEvent>();
+  });
+  instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(4);
+  });
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 3);
+
+  AlphaEvent event;
+  EXPECT_EQ(instance->emit(event), 2);
+  EXPECT_EQ(calls, std::vector<int>({ 1, 2 }));
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 0);
+  EXPECT_EQ(instance->emit(event), 0);
+
+  calls.clear();
+  instance->once<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(5);
+    AlphaEvent nested;
+    // the once listener is not called again
+    instance->emit(nested);
+  });
+  EXPECT_EQ(instance->emit(event), 1);
+  EXPECT_EQ(calls, std::vector<int>({ 5 }));
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 0);
+}
+
+TEST_F(EmitterTest, ListenerTokens) {
+  std::shared_ptr<TestObject> instance(TestObject::create(basic_params_));
+  std::vector<int> calls;
+  AlphaEvent event;
+
+  ListenerToken first = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(1);
+  });
+  ListenerToken second = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(2);
+  });
+  ListenerToken third = instance->once<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(3);
+  });
+  EXPECT_TRUE(first.valid());
+  EXPECT_FALSE(ListenerToken().valid());
+
+  EXPECT_TRUE(instance->off(second));
+  EXPECT_FALSE(instance->off(second));
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 2);
+  EXPECT_EQ(instance->emit(event), 2);
+  EXPECT_EQ(calls, std::vector<int>({ 1, 3 }));
+  // called once
+  EXPECT_FALSE(instance->off(third));
+
+  // the slot of the second one is reused, in the order of adding
+  calls.clear();
+  ListenerToken fourth = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(4);
+  });
+  EXPECT_FALSE(instance->off(second));
+  EXPECT_EQ(instance->emit(event), 2);
+  EXPECT_EQ(calls, std::vector<int>({ 1, 4 }));
+
+  // removed during the call: itself, the next one and one added during the call
+  calls.clear();
+  ListenerToken next;
+  ListenerToken added;
+  EXPECT_TRUE(instance->off(first));
+  EXPECT_TRUE(instance->off(fourth));
+  first = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(5);
+    EXPECT_TRUE(instance->off(next));
+    EXPECT_TRUE(instance->off(first));
+    added = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+      calls.push_back(6);
+    });
+    EXPECT_TRUE(instance->off(added));
+  });
+  next = instance->on<AlphaEvent>([&](AlphaEvent& event, auto& resource) -> void {
+    calls.push_back(7);
+  });
+  EXPECT_EQ(instance->emit(event), 1);
+  EXPECT_EQ(calls, std::vector<int>({ 5 }));
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 0);
+  EXPECT_EQ(instance->emit(event), 0);
+  EXPECT_FALSE(instance->off(added));
+
+  // tokens do not match the listeners after offAll
+  ListenerToken other = instance->on<AppleEvent>([&](AppleEvent& event, auto& resource) -> void {});
+  instance->offAll();
+  instance->on<AppleEvent>([&](AppleEvent& event, auto& resource) -> void {});
+  EXPECT_FALSE(instance->off(other));
+  EXPECT_EQ(instance->getEventCount<AppleEvent>(), 1);
+}
+
+TEST_F(EmitterTest, ListenersDoNotAllocate) {
+  std::shared_ptr<TestObject> instance(TestObject::create(basic_params_));
+  int value = 0;
+  int* counter = &value;
+  // listeners of a connection, small enough to be stored inside std::function
+  auto setup = [&]() -> void {
+    instance->once<AlphaEvent>([counter](AlphaEvent& event, auto& handle) -> void { (*counter)++; });
+    instance->on<AlphaEvent>([counter](AlphaEvent& event, auto& handle) -> void { (*counter)++; });
+    instance->on<AppleEvent>([counter](AppleEvent& event, auto& handle) -> void { (*counter)++; });
+    instance->once<CloseEvent>([counter](CloseEvent& event, auto& handle) -> void { (*counter)++; });
+  };
+
+  size_t before = getThreadAllocationCount();
+  setup();
+  size_t first = getThreadAllocationCount() - before;
+  // a handler per event type and the handler array, none per listener
+  EXPECT_LE(first, 3 + 3);
+
+  // a reused connection
+  instance->offAll();
+  before = getThreadAllocationCount();
+  setup();
+  EXPECT_EQ(getThreadAllocationCount() - before, 0);
+  EXPECT_EQ(instance->getEventCount<AlphaEvent>(), 2);
+}
+
 TEST_F(EmitterTest, AutoInitTestOnce) {
   std::shared_ptr<TestObject> instance(TestObject::create(basic_params_));
   std::atomic_int result(0);
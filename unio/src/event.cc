@@ -7,9 +7,12 @@
  *            of the Apache License 2.0.  See the LICENSE file for details.
  */
 
+#include <atomic>
+
 #include <uv.h>
 
 #include <jcu-unio/event.h>
+#include <jcu-unio/emitter.h>
 
 namespace jcu {
 namespace unio {
@@ -48,6 +51,11 @@ const ErrorEvent &AbstractEvent::error() const {
   return *error_;
 }
 
+size_t allocateEventTypeId() {
+  static std::atomic<size_t> next_id(0);
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 InitEvent::InitEvent() :
   AbstractEvent(nullptr) {}
 InitEvent::InitEvent(std::shared_ptr<ErrorEvent> error) :
@@ -0,0 +1,79 @@
+/**
+ * @file	histogram.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <jcu-unio/histogram.h>
+
+namespace jcu {
+namespace unio {
+
+const int Histogram::kSubBucketBits;
+const uint64_t Histogram::kMaxValue;
+const size_t Histogram::kBucketCount;
+
+double HistogramSnapshot::mean() const {
+  return count ? ((double) sum / (double) count) : 0.0;
+}
+
+uint64_t HistogramSnapshot::percentile(double percent) const {
+  if (!count) {
+    return 0;
+  }
+  uint64_t target = (uint64_t) ((percent / 100.0) * (double) count + 0.5);
+  if (target < 1) {
+    target = 1;
+  }
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    accumulated += buckets[i];
+    if (accumulated >= target) {
+      uint64_t upper = Histogram::getBucketValue(i + 1) - 1;
+      return (upper < max) ? upper : max;
+    }
+  }
+  return max;
+}
+
+Histogram::Histogram() {
+  reset();
+}
+
+uint64_t Histogram::getBucketValue(size_t index) {
+  const size_t half = 1U << (kSubBucketBits - 1);
+  if (index < (1U << kSubBucketBits)) {
+    return index;
+  }
+  size_t shift = index / half - 1;
+  return (uint64_t) (index - shift * half) << shift;
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.count = count_.load(std::memory_order_acquire);
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  snapshot.max = max_.load(std::memory_order_relaxed);
+  snapshot.min = snapshot.count ? min_.load(std::memory_order_relaxed) : 0;
+  snapshot.buckets.resize(kBucketCount);
+  for (size_t i = 0; i < kBucketCount; i++) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+void Histogram::reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(UINT64_MAX, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_release);
+}
+
+} // namespace unio
+} // namespace jcu
@@ -0,0 +1,61 @@
+/**
+ * @file	histogram_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include "../test/unit_test_utils.h"
+#include <jcu-unio/histogram.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+TEST(HistogramTest, BucketBounds) {
+  EXPECT_EQ(Histogram::getBucketIndex(0), 0);
+  EXPECT_EQ(Histogram::getBucketIndex(15), 15);
+  EXPECT_EQ(Histogram::getBucketIndex(Histogram::kMaxValue), Histogram::kBucketCount - 1);
+  EXPECT_EQ(Histogram::getBucketIndex(UINT64_MAX), Histogram::kBucketCount - 1);
+
+  size_t last_index = 0;
+  for (uint64_t value = 1; value < Histogram::kMaxValue; value += value / 7 + 1) {
+    size_t index = Histogram::getBucketIndex(value);
+    ASSERT_GE(index, last_index);
+    ASSERT_LE(Histogram::getBucketValue(index), value);
+    ASSERT_GT(Histogram::getBucketValue(index + 1), value);
+    // relative error of a bucket is less than 1/8
+    ASSERT_LE(Histogram::getBucketValue(index + 1) - Histogram::getBucketValue(index), value / 8 + 1);
+    last_index = index;
+  }
+}
+
+TEST(HistogramTest, Percentile) {
+  Histogram histogram;
+  for (uint64_t value = 1; value <= 1000; value++) {
+    histogram.record(value * 1000);
+  }
+  HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1000);
+  EXPECT_EQ(snapshot.min, 1000);
+  EXPECT_EQ(snapshot.max, 1000000);
+  EXPECT_DOUBLE_EQ(snapshot.mean(), 500500.0);
+
+  uint64_t p50 = snapshot.percentile(50);
+  EXPECT_GE(p50, 500000);
+  EXPECT_LE(p50, 500000 * 9 / 8);
+  uint64_t p99 = snapshot.percentile(99);
+  EXPECT_GE(p99, 990000);
+  EXPECT_LE(p99, 1000000);
+  EXPECT_EQ(snapshot.percentile(100), 1000000);
+
+  histogram.reset();
+  snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 0);
+  EXPECT_EQ(snapshot.min, 0);
+  EXPECT_EQ(snapshot.percentile(50), 0);
+}
+
+} // namespace
@@ -7,66 +7,666 @@
  *            of the Apache License 2.0.  See the LICENSE file for details.
  */
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <memory>
 #include <cstdlib>
 #include <cstring>
-#include <mutex>
-#include <deque>
+#include <atomic>
+#include <thread>
 
 #include <jcu-unio/loop.h>
+#include <jcu-unio/work_pool.h>
+#include <jcu-unio/uv_helper.h>
+
+#include "mpsc_queue.h"
 
 namespace jcu {
 namespace unio {
 
-struct QueuedTaskResource {
+struct QueuedTaskNode : MpscNode {
   QueuedTask_t task;
+  QueuedTaskNode* next_free;
+  /**
+   * uv_hrtime() of sendQueuedTask, 0 if the metrics are disabled
+   */
+  uint64_t queued_at;
+
+  QueuedTaskNode() :
+      next_free(nullptr),
+      queued_at(0) {}
+};
+
+/**
+ * Recycles the queue nodes, shared by all loops.
+ *
+ * The loop threads push the nodes they have run to a lock-free stack,
+ * and a producer takes the whole stack at once (no ABA) into its thread-local cache.
+ */
+class QueuedTaskNodePool {
+ private:
+  static const size_t kMaxFreeNodes = 4096;
+
+  std::atomic<QueuedTaskNode*> free_;
+  std::atomic<size_t> free_count_;
+
+  struct LocalCache {
+    QueuedTaskNode* head;
+
+    LocalCache() : head(nullptr) {}
+    ~LocalCache() {
+      deleteNodes(head);
+    }
+  };
+
+  static LocalCache& localCache() {
+    static thread_local LocalCache cache;
+    return cache;
+  }
+
+  static void deleteNodes(QueuedTaskNode* node) {
+    while (node) {
+      QueuedTaskNode* next = node->next_free;
+      delete node;
+      node = next;
+    }
+  }
+
+ public:
+  QueuedTaskNodePool() :
+      free_(nullptr),
+      free_count_(0)
+  {}
+
+  ~QueuedTaskNodePool() {
+    deleteNodes(free_.exchange(nullptr));
+  }
+
+  static QueuedTaskNodePool& get() {
+    static QueuedTaskNodePool pool;
+    return pool;
+  }
+
+  QueuedTaskNode* acquire() {
+    LocalCache& cache = localCache();
+    if (!cache.head && free_.load(std::memory_order_relaxed)) {
+      cache.head = free_.exchange(nullptr, std::memory_order_acquire);
+      size_t count = 0;
+      for (QueuedTaskNode* node = cache.head; node; node = node->next_free) {
+        count++;
+      }
+      free_count_.fetch_sub(count, std::memory_order_relaxed);
+    }
+    QueuedTaskNode* node = cache.head;
+    if (node) {
+      cache.head = node->next_free;
+      return node;
+    }
+    return new QueuedTaskNode();
+  }
+
+  void release(QueuedTaskNode* node) {
+    if (free_count_.fetch_add(1, std::memory_order_relaxed) >= kMaxFreeNodes) {
+      free_count_.fetch_sub(1, std::memory_order_relaxed);
+      delete node;
+      return ;
+    }
+    node->next_free = free_.load(std::memory_order_relaxed);
+    while (!free_.compare_exchange_weak(node->next_free, node, std::memory_order_release, std::memory_order_relaxed)) {}
+  }
+};
+
+struct TaskLane {
+  MpscQueue queue;
+  /**
+   * tasks pushed and not yet run.
+   * The producer that makes it non-zero wakes the loop.
+   */
+  std::atomic<size_t> pending;
+
+  TaskLane() : pending(0) {}
 };
 
+/**
+ * set on the loop thread together with the owner thread, see LoopContext::enterLoopThread
+ */
+static thread_local const Loop* current_loop = nullptr;
+
 struct LoopContext {
+  /**
+   * 1 of this many queued tasks is measured
+   */
+  static const uint32_t kQueuedTaskWaitSampling = 8;
+  /**
+   * normal tasks run between the checks of the high lane
+   */
+  static const size_t kHighLaneCheckInterval = 16;
+  /**
+   * idle tasks run per loop iteration
+   */
+  static const size_t kIdleBatch = 16;
+  /**
+   * nanoseconds of idle tasks per loop iteration
+   */
+  static const uint64_t kIdleBatchTime = 1000000;
+
+  const Loop* loop;
   uv_async_t queue_handle;
-  std::recursive_mutex mutex;
-  std::deque<QueuedTaskResource> queue;
+  /**
+   * runs the idle lane while it is not empty
+   */
+  uv_idle_t idle_handle;
+  bool idle_active;
+  /**
+   * queue_handle is initialized and not closed
+   */
+  std::atomic<bool> ready;
+  TaskLane lanes[kTaskPriorityCount];
+  /**
+   * the thread running the queue handle
+   */
+  std::atomic<std::thread::id> owner_thread;
+
+  std::atomic<size_t> max_tasks;
+  std::atomic<uint64_t> max_time;
+
+  std::atomic<uint64_t> iterations;
+  std::atomic<uint64_t> tasks_run;
+  std::atomic<uint64_t> last_tasks_run;
+  std::atomic<uint64_t> max_tasks_run;
+  std::atomic<uint64_t> deferred_iterations;
+  std::atomic<uint64_t> deferred_tasks;
+
+  std::atomic<size_t> sockets;
+
+  std::shared_ptr<WorkPool> work_pool;
+
+  std::atomic<bool> metrics_enabled;
+  /**
+   * below are accessed only in the loop thread, except the histograms
+   */
+  bool metrics_started;
+  uv_prepare_t metrics_prepare;
+  uint64_t last_prepare_time;
+  uint64_t last_idle_time;
+  std::atomic<uint64_t> metrics_iterations;
+  Histogram iteration_time;
+  Histogram idle_time;
+  Histogram busy_time;
+  Histogram queued_task_wait;
+
+  explicit LoopContext(const Loop* loop) :
+      loop(loop),
+      idle_active(false),
+      ready(false),
+      owner_thread(std::thread::id()),
+      iterations(0),
+      tasks_run(0),
+      last_tasks_run(0),
+      max_tasks_run(0),
+      deferred_iterations(0),
+      deferred_tasks(0),
+      sockets(0),
+      metrics_enabled(false),
+      metrics_started(false),
+      last_prepare_time(0),
+      last_idle_time(0),
+      metrics_iterations(0)
+  {
+    QueuedTaskBudget budget;
+    max_tasks.store(budget.max_tasks);
+    max_time.store(budget.max_time);
+  }
+
+  ~LoopContext() {
+    for (auto& lane : lanes) {
+      for (;;) {
+        auto* node = static_cast<QueuedTaskNode*>(lane.queue.pop());
+        if (!node) break;
+        node->task.reset();
+        QueuedTaskNodePool::get().release(node);
+      }
+    }
+  }
+
+  static QueuedTaskNode* popQueuedTask(TaskLane& lane) {
+    for (;;) {
+      auto* node = static_cast<QueuedTaskNode*>(lane.queue.pop());
+      if (node) {
+        return node;
+      }
+      // counted but not linked yet: the producer is between two instructions of push()
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Run up to max_count tasks of the lane
+   *
+   * @param deadline uv_hrtime, 0 for unlimited
+   * @return tasks run
+   */
+  size_t drainLane(TaskLane& lane, size_t max_count, uint64_t deadline, bool& timeout) {
+    QueuedTaskNodePool& pool = QueuedTaskNodePool::get();
+    size_t count = lane.pending.load(std::memory_order_acquire);
+    if (count > max_count) {
+      count = max_count;
+    }
+    size_t i = 0;
+    while (i < count) {
+      QueuedTaskNode* node = popQueuedTask(lane);
+      QueuedTask_t task(std::move(node->task));
+      if (node->queued_at) {
+        queued_task_wait.record(uv_hrtime() - node->queued_at);
+      }
+      pool.release(node);
+      task();
+      i++;
+      // read the clock every 8 tasks
+      if (deadline && !(i & 7) && (uv_hrtime() >= deadline)) {
+        timeout = true;
+        break;
+      }
+    }
+    if (i) {
+      lane.pending.fetch_sub(i, std::memory_order_acq_rel);
+    }
+    return i;
+  }
+
+  /**
+   * called on the loop thread before running tasks
+   */
+  void enterLoopThread() {
+    std::thread::id current = std::this_thread::get_id();
+    if (owner_thread.load(std::memory_order_relaxed) != current) {
+      owner_thread.store(current, std::memory_order_relaxed);
+    }
+    current_loop = loop;
+  }
 
   void processQueuedTask() {
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    while (!queue.empty()) {
-      QueuedTaskResource resource = std::move(queue.front());
-      queue.pop_front();
-      resource.task();
+    enterLoopThread();
+
+    size_t task_limit = max_tasks.load(std::memory_order_relaxed);
+    uint64_t time_limit = max_time.load(std::memory_order_relaxed);
+    uint64_t deadline = time_limit ? (uv_hrtime() + time_limit) : 0;
+    size_t run = 0;
+    bool timeout = false;
+
+    TaskLane& high = lanes[kTaskPriorityHigh];
+    TaskLane& normal = lanes[kTaskPriorityNormal];
+    // tasks added meanwhile (also by the tasks themselves) are run in this iteration if the budget allows
+    while (!timeout) {
+      size_t room = task_limit ? (task_limit - run) : SIZE_MAX;
+      size_t n = drainLane(high, room, deadline, timeout);
+      run += n;
+      room -= (room != SIZE_MAX) ? n : 0;
+      if (timeout || !room) {
+        break;
+      }
+      size_t m = drainLane(normal, std::min(room, kHighLaneCheckInterval), deadline, timeout);
+      run += m;
+      if (!n && !m) {
+        break;
+      }
+    }
+    size_t count = high.pending.load(std::memory_order_acquire) + normal.pending.load(std::memory_order_acquire);
+
+    iterations.fetch_add(1, std::memory_order_relaxed);
+    tasks_run.fetch_add(run, std::memory_order_relaxed);
+    last_tasks_run.store(run, std::memory_order_relaxed);
+    if (run > max_tasks_run.load(std::memory_order_relaxed)) {
+      max_tasks_run.store(run, std::memory_order_relaxed);
+    }
+    if (count > 0) {
+      deferred_iterations.fetch_add(1, std::memory_order_relaxed);
+      deferred_tasks.fetch_add(count, std::memory_order_relaxed);
+      // producers do not wake the loop while pending is non-zero,
+      // the async is handled in the next poll together with the I/O events
+      uv_async_send(&queue_handle);
+    }
+
+    if (!idle_active && lanes[kTaskPriorityIdle].pending.load(std::memory_order_acquire)) {
+      idle_active = true;
+      uv_idle_start(&idle_handle, [](uv_idle_t* handle) -> void {
+        LoopContext* self = (LoopContext*) uv_handle_get_data((uv_handle_t*) handle);
+        self->processIdleTask();
+      });
     }
   }
 
-  void addQueuedTask(QueuedTask_t&& task) {
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    QueuedTaskResource resource { task };
-    queue.emplace_back(std::move(resource));
-    if (queue_handle.type) {
-      int rc = uv_async_send(&queue_handle);
+  /**
+   * called by the idle handle once per loop iteration, while the idle lane is not empty.
+   * The loop does not block in poll meanwhile, so I/O is handled between the batches.
+   */
+  void processIdleTask() {
+    enterLoopThread();
+    TaskLane& idle = lanes[kTaskPriorityIdle];
+    bool busy = lanes[kTaskPriorityHigh].pending.load(std::memory_order_acquire)
+        || lanes[kTaskPriorityNormal].pending.load(std::memory_order_acquire);
+    if (!busy) {
+      bool timeout = false;
+      drainLane(idle, kIdleBatch, uv_hrtime() + kIdleBatchTime, timeout);
+    }
+    if (!idle.pending.load(std::memory_order_acquire)) {
+      // a producer making it non-zero after this wakes the loop to start it again
+      idle_active = false;
+      uv_idle_stop(&idle_handle);
+    }
+  }
+
+  void startMetrics(uv_loop_t* loop) {
+    if (metrics_started) {
+      return ;
+    }
+    metrics_started = true;
+    uv_loop_configure(loop, UV_METRICS_IDLE_TIME);
+    uv_prepare_init(loop, &metrics_prepare);
+    uv_handle_set_data((uv_handle_t*) &metrics_prepare, this);
+    uv_prepare_start(&metrics_prepare, [](uv_prepare_t* handle) -> void {
+      LoopContext* self = (LoopContext*) uv_handle_get_data((uv_handle_t*) handle);
+      self->measureIteration(handle->loop);
+    });
+    // the metrics do not keep the loop alive
+    uv_unref((uv_handle_t*) &metrics_prepare);
+    // the current iteration is measured from now
+    last_prepare_time = uv_hrtime();
+    last_idle_time = uv_metrics_idle_time(loop);
+  }
+
+  void stopMetrics() {
+    if (!metrics_started) {
+      return ;
+    }
+    metrics_started = false;
+    uv_close((uv_handle_t*) &metrics_prepare, nullptr);
+  }
+
+  /**
+   * called before polling for I/O
+   */
+  void measureIteration(uv_loop_t* loop) {
+    uint64_t now = uv_hrtime();
+    uint64_t idle = uv_metrics_idle_time(loop);
+    if (last_prepare_time) {
+      uint64_t iteration = now - last_prepare_time;
+      uint64_t idle_delta = idle - last_idle_time;
+      if (idle_delta > iteration) {
+        idle_delta = iteration;
+      }
+      iteration_time.record(iteration);
+      idle_time.record(idle_delta);
+      busy_time.record(iteration - idle_delta);
+      metrics_iterations.fetch_add(1, std::memory_order_relaxed);
+    }
+    last_prepare_time = now;
+    last_idle_time = idle;
+  }
+
+  void resetMetrics() {
+    iteration_time.reset();
+    idle_time.reset();
+    busy_time.reset();
+    queued_task_wait.reset();
+    metrics_iterations.store(0, std::memory_order_relaxed);
+    last_prepare_time = 0;
+  }
+
+  void addQueuedTask(QueuedTask_t&& task, TaskPriority priority) {
+    TaskLane& lane = lanes[priority];
+    QueuedTaskNode* node = QueuedTaskNodePool::get().acquire();
+    node->task = std::move(task);
+    node->queued_at = 0;
+    if (metrics_enabled.load(std::memory_order_relaxed)) {
+      // sampled, so that reading the clock twice costs little per task
+      static thread_local uint32_t sample_counter = 0;
+      if (!(sample_counter++ % kQueuedTaskWaitSampling)) {
+        node->queued_at = uv_hrtime();
+      }
+    }
+    lane.queue.push(node);
+    if (lane.pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+      if (ready.load(std::memory_order_acquire)) {
+        uv_async_send(&queue_handle);
+      }
     }
   }
 };
 
+const size_t LoopContext::kHighLaneCheckInterval;
+const size_t LoopContext::kIdleBatch;
+const uint64_t LoopContext::kIdleBatchTime;
+
 Loop::Loop() {
-  ctx_ = std::make_unique<LoopContext>();
+  ctx_ = std::make_unique<LoopContext>(this);
   std::memset(&ctx_->queue_handle, 0, sizeof(ctx_->queue_handle));
+  std::memset(&ctx_->idle_handle, 0, sizeof(ctx_->idle_handle));
 }
 
 void Loop::init() {
-  std::lock_guard<std::recursive_mutex> lock(ctx_->mutex);
   uv_async_init(get(), &ctx_->queue_handle, [](uv_async_t* handle) -> void {
     Loop* self = (Loop*) uv_handle_get_data((uv_handle_t*) handle);
     self->ctx_->processQueuedTask();
   });
   uv_handle_set_data((uv_handle_t*)&ctx_->queue_handle, this);
+  uv_idle_init(get(), &ctx_->idle_handle);
+  uv_handle_set_data((uv_handle_t*)&ctx_->idle_handle, ctx_.get());
+  ctx_->idle_active = false;
+  ctx_->ready.store(true, std::memory_order_release);
+  // run the tasks queued before init
   uv_async_send(&ctx_->queue_handle);
 }
 
 void Loop::uninit() {
+  ctx_->ready.store(false, std::memory_order_release);
+  ctx_->owner_thread.store(std::thread::id(), std::memory_order_relaxed);
+  if (current_loop == this) {
+    current_loop = nullptr;
+  }
+  ctx_->stopMetrics();
+  ctx_->idle_active = false;
+  uv_close((uv_handle_t*)&ctx_->idle_handle, nullptr);
   uv_close((uv_handle_t*)&ctx_->queue_handle, [](uv_handle_t* handle) -> void {});
 }
 
+void Loop::closeHandles() {
+  if (ctx_->ready.load(std::memory_order_acquire)) {
+    uninit();
+  }
+  // the handles of the loop itself are closing now
+  uv_walk(get(), [](uv_handle_t* handle, void* /* arg */) -> void {
+    if (uv_is_closing(handle)) {
+      return ;
+    }
+    UvRefBase* ref = (UvRefBase*) uv_handle_get_data(handle);
+    if (ref) {
+      ref->forceClose();
+    } else {
+      uv_close(handle, nullptr);
+    }
+  }, nullptr);
+}
+
 void Loop::sendQueuedTask(QueuedTask_t&& task) const {
-  ctx_->addQueuedTask(std::move(task));
+  ctx_->addQueuedTask(std::move(task), kTaskPriorityNormal);
+}
+
+void Loop::post(QueuedTask_t&& task) const {
+  ctx_->addQueuedTask(std::move(task), kTaskPriorityNormal);
+}
+
+void Loop::post(QueuedTask_t&& task, TaskPriority priority) const {
+  ctx_->addQueuedTask(std::move(task), priority);
+}
+
+void Loop::dispatch(QueuedTask_t&& task) const {
+  if (isInLoopThread()) {
+    task();
+    return ;
+  }
+  ctx_->addQueuedTask(std::move(task), kTaskPriorityNormal);
+}
+
+bool Loop::isInLoopThread() const {
+  return ctx_->owner_thread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+std::thread::id Loop::getThreadId() const {
+  return ctx_->owner_thread.load(std::memory_order_relaxed);
+}
+
+const Loop* Loop::getCurrent() {
+  // a loop moved to another thread is not current on the previous one
+  return (current_loop && current_loop->isInLoopThread()) ? current_loop : nullptr;
+}
+
+void Loop::setQueuedTaskBudget(const QueuedTaskBudget& budget) {
+  ctx_->max_tasks.store(budget.max_tasks, std::memory_order_relaxed);
+  ctx_->max_time.store(budget.max_time, std::memory_order_relaxed);
+}
+
+QueuedTaskBudget Loop::getQueuedTaskBudget() const {
+  QueuedTaskBudget budget;
+  budget.max_tasks = ctx_->max_tasks.load(std::memory_order_relaxed);
+  budget.max_time = ctx_->max_time.load(std::memory_order_relaxed);
+  return budget;
+}
+
+QueuedTaskStats Loop::getQueuedTaskStats() const {
+  QueuedTaskStats stats;
+  stats.iterations = ctx_->iterations.load(std::memory_order_relaxed);
+  stats.tasks_run = ctx_->tasks_run.load(std::memory_order_relaxed);
+  stats.last_tasks_run = ctx_->last_tasks_run.load(std::memory_order_relaxed);
+  stats.max_tasks_run = ctx_->max_tasks_run.load(std::memory_order_relaxed);
+  stats.deferred_iterations = ctx_->deferred_iterations.load(std::memory_order_relaxed);
+  stats.deferred_tasks = ctx_->deferred_tasks.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Loop::enableMetrics() {
+  if (ctx_->metrics_enabled.exchange(true)) {
+    return ;
+  }
+  const Loop* self = this;
+  sendQueuedTask([self]() -> void {
+    self->ctx_->startMetrics(self->get());
+  });
+}
+
+bool Loop::isMetricsEnabled() const {
+  return ctx_->metrics_enabled.load(std::memory_order_relaxed);
+}
+
+LoopMetricsSnapshot Loop::getMetrics() const {
+  LoopMetricsSnapshot snapshot;
+  snapshot.iterations = ctx_->metrics_iterations.load(std::memory_order_relaxed);
+  snapshot.iteration_time = ctx_->iteration_time.snapshot();
+  snapshot.idle_time = ctx_->idle_time.snapshot();
+  snapshot.busy_time = ctx_->busy_time.snapshot();
+  snapshot.queued_task_wait = ctx_->queued_task_wait.snapshot();
+  return snapshot;
+}
+
+void Loop::resetMetrics() {
+  const Loop* self = this;
+  sendQueuedTask([self]() -> void {
+    self->ctx_->resetMetrics();
+  });
+}
+
+size_t Loop::getSocketCount() const {
+  return ctx_->sockets.load(std::memory_order_relaxed);
+}
+
+void Loop::attachSocket() {
+  ctx_->sockets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Loop::detachSocket() {
+  ctx_->sockets.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Loop::setWorkPool(std::shared_ptr<WorkPool> pool) {
+  std::atomic_store(&ctx_->work_pool, std::move(pool));
+}
+
+std::shared_ptr<WorkPool> Loop::getWorkPool() const {
+  return std::atomic_load(&ctx_->work_pool);
+}
+
+struct WorkRequest {
+  uv_work_t req;
+  std::shared_ptr<Loop> loop;
+  WorkTask_t work;
+  QueuedTask_t completion;
+  /**
+   * may be empty
+   */
+  WorkErrorTask_t error;
+
+  void fail(int status) {
+    if (error) {
+      error(status);
+    }
+  }
+
+  static void workCallback(uv_work_t* req) {
+    WorkRequest* request = (WorkRequest*) uv_req_get_data((uv_req_t*) req);
+    request->work();
+  }
+
+  static void afterWorkCallback(uv_work_t* req, int status) {
+    std::unique_ptr<WorkRequest> request((WorkRequest*) uv_req_get_data((uv_req_t*) req));
+    if (status == 0) {
+      request->completion();
+    } else {
+      // UV_ECANCELED: the work was not run
+      request->fail(status);
+    }
+  }
+};
+
+void Loop::submitWork(WorkTask_t&& work, QueuedTask_t&& completion) const {
+  submitWork(std::move(work), std::move(completion), WorkErrorTask_t());
+}
+
+void Loop::submitWork(WorkTask_t&& work, QueuedTask_t&& completion, WorkErrorTask_t&& error) const {
+  std::unique_ptr<WorkRequest> request(new WorkRequest());
+  request->loop = shared();
+  request->work = std::move(work);
+  request->completion = std::move(completion);
+  request->error = std::move(error);
+  uv_req_set_data((uv_req_t*) &request->req, request.get());
+
+  std::shared_ptr<WorkPool> pool(getWorkPool());
+  if (pool) {
+    WorkRequest* ptr = request.get();
+    // a submitted work is always run (WorkPool::shutdown runs the rest)
+    if (pool->submit([ptr]() -> void {
+      std::unique_ptr<WorkRequest> request(ptr);
+      request->work();
+      std::shared_ptr<Loop> loop(std::move(request->loop));
+      QueuedTask_t completion(std::move(request->completion));
+      request.reset();
+      loop->sendQueuedTask(std::move(completion));
+    })) {
+      request.release();
+      return ;
+    }
+    // the pool is shut down, falls back to the libuv threadpool
+  }
+
+  // uv_queue_work is not thread-safe
+  dispatch([request = std::move(request)]() mutable -> void {
+    int rc = uv_queue_work(request->loop->get(), &request->req, WorkRequest::workCallback, WorkRequest::afterWorkCallback);
+    if (rc == 0) {
+      request.release();
+      return ;
+    }
+    request->fail(rc);
+  });
 }
 
 class UnsafeLoopImpl : public UnsafeLoop {
@@ -0,0 +1,344 @@
+/**
+ * @file	loop_group.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <jcu-unio/loop_group.h>
+
+namespace jcu {
+namespace unio {
+
+/**
+ * State of a loop thread that the thread itself owns,
+ * so that it outlives the group when the group is released on a loop thread.
+ */
+struct LoopThreadContext {
+  std::shared_ptr<SharedLoop> loop;
+  /**
+   * wakes the loop to close its handles, see LoopGroupImpl::closeLoops
+   */
+  uv_async_t close_handle;
+
+  std::mutex mutex;
+  /**
+   * close_handle can be sent
+   */
+  bool running;
+  bool close_requested;
+
+  explicit LoopThreadContext(std::shared_ptr<SharedLoop> loop) :
+      loop(std::move(loop)),
+      running(false),
+      close_requested(false)
+  {
+    std::memset(&close_handle, 0, sizeof(close_handle));
+  }
+
+  /**
+   * called on the loop thread
+   */
+  void closeHandles() {
+    if (!uv_is_closing((uv_handle_t*) &close_handle)) {
+      uv_close((uv_handle_t*) &close_handle, nullptr);
+    }
+    loop->closeHandles();
+  }
+};
+
+class LoopGroupImpl : public LoopGroup {
+ public:
+  LoopPlacement placement_;
+  std::vector<std::shared_ptr<SharedLoop>> loops_;
+
+  std::mutex threads_mutex_;
+  std::vector<std::thread> threads_;
+  std::vector<std::shared_ptr<LoopThreadContext>> thread_contexts_;
+  bool started_;
+  bool stopped_;
+
+  std::atomic<size_t> next_index_;
+
+  NumaMemoryPolicy numa_memory_;
+  std::shared_ptr<Logger> logger_;
+  CpuTopology topology_;
+
+  mutable std::mutex placements_mutex_;
+  std::condition_variable placements_cond_;
+  /**
+   * planned by the constructor, and updated by each loop thread
+   */
+  std::vector<LoopThreadPlacement> placements_;
+  size_t placed_count_;
+
+  explicit LoopGroupImpl(const LoopGroupOptions& options) :
+      placement_(options.placement),
+      started_(false),
+      stopped_(false),
+      next_index_(0),
+      numa_memory_(options.numa_memory),
+      logger_(options.logger),
+      topology_(CpuTopology::detect()),
+      placed_count_(0)
+  {
+    size_t count = options.threads;
+    if (!count) {
+      count = std::thread::hardware_concurrency();
+    }
+    if (!count) {
+      count = 1;
+    }
+    loops_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      loops_.emplace_back(SharedLoop::create());
+      loops_.back()->setWorkPool(options.work_pool);
+    }
+    planPlacements(options);
+  }
+
+  void planPlacements(const LoopGroupOptions& options) {
+    std::vector<int> cpus(options.cpus.empty() ? topology_.cpus : options.cpus);
+    std::vector<int> nodes;
+    for (int node : topology_.nodes) {
+      for (int cpu : cpus) {
+        if (topology_.getNumaNode(cpu) == node) {
+          nodes.push_back(node);
+          break;
+        }
+      }
+    }
+
+    placements_.resize(loops_.size());
+    for (size_t i = 0; i < loops_.size(); i++) {
+      LoopThreadPlacement& placement = placements_[i];
+      placement.index = i;
+      if ((options.affinity == kAffinityCpu) && !cpus.empty()) {
+        int cpu = cpus[i % cpus.size()];
+        placement.cpus.push_back(cpu);
+        placement.numa_node = topology_.getNumaNode(cpu);
+      } else if ((options.affinity == kAffinityNumaNode) && !nodes.empty()) {
+        int node = nodes[i % nodes.size()];
+        for (int cpu : cpus) {
+          if (topology_.getNumaNode(cpu) == node) {
+            placement.cpus.push_back(cpu);
+          }
+        }
+        placement.numa_node = node;
+      }
+    }
+  }
+
+  /**
+   * called on the loop thread before it runs
+   */
+  void applyPlacement(size_t index) {
+    LoopThreadPlacement placement;
+    {
+      std::lock_guard<std::mutex> lock(placements_mutex_);
+      placement = placements_[index];
+    }
+    if (!placement.cpus.empty()) {
+      placement.affinity_error = setThreadAffinity(placement.cpus);
+    }
+    if (placement.numa_node < 0) {
+      placement.numa_node = topology_.getNumaNode(getCurrentCpu());
+    }
+    if ((numa_memory_ != kNumaMemoryDefault) && (placement.numa_node >= 0)) {
+      placement.memory_error = setThreadNumaMemory(placement.numa_node, numa_memory_);
+    }
+    {
+      std::lock_guard<std::mutex> lock(placements_mutex_);
+      placements_[index] = placement;
+      placed_count_++;
+    }
+    placements_cond_.notify_all();
+  }
+
+  ~LoopGroupImpl() override {
+    closeLoops();
+    join();
+  }
+
+  /**
+   * Close every handle left on the loops, so that the threads exit.
+   */
+  void closeLoops() {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    stopped_ = true;
+    for (auto& context : thread_contexts_) {
+      std::lock_guard<std::mutex> context_lock(context->mutex);
+      context->close_requested = true;
+      if (context->running) {
+        uv_async_send(&context->close_handle);
+      }
+    }
+  }
+
+  void start() override {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    if (started_) {
+      return ;
+    }
+    started_ = true;
+    threads_.reserve(loops_.size());
+    thread_contexts_.reserve(loops_.size());
+    for (size_t i = 0; i < loops_.size(); i++) {
+      std::shared_ptr<LoopThreadContext> context(std::make_shared<LoopThreadContext>(loops_[i]));
+      uv_loop_t* loop = context->loop->get();
+      uv_async_init(loop, &context->close_handle, [](uv_async_t* handle) -> void {
+        LoopThreadContext* context = (LoopThreadContext*) uv_handle_get_data((uv_handle_t*) handle);
+        context->closeHandles();
+      });
+      uv_handle_set_data((uv_handle_t*) &context->close_handle, context.get());
+      // it does not keep the loop alive
+      uv_unref((uv_handle_t*) &context->close_handle);
+      context->running = true;
+      thread_contexts_.emplace_back(context);
+      // this is used only until start() returns, it waits for applyPlacement
+      threads_.emplace_back([this, i, context]() -> void {
+        applyPlacement(i);
+        uv_loop_t* loop = context->loop->get();
+        context->loop->init();
+        uv_run(loop, UV_RUN_DEFAULT);
+        bool close_requested;
+        {
+          std::lock_guard<std::mutex> lock(context->mutex);
+          context->running = false;
+          close_requested = context->close_requested;
+        }
+        if (close_requested) {
+          // the loop exited before close_handle was received
+          context->closeHandles();
+        } else if (!uv_is_closing((uv_handle_t*) &context->close_handle)) {
+          uv_close((uv_handle_t*) &context->close_handle, nullptr);
+        }
+        uv_run(loop, UV_RUN_DEFAULT);
+      });
+    }
+
+    {
+      std::unique_lock<std::mutex> placements_lock(placements_mutex_);
+      placements_cond_.wait(placements_lock, [this]() -> bool {
+        return placed_count_ == loops_.size();
+      });
+    }
+    if (logger_) {
+      std::string report(getTopologyReport());
+      logger_->logf(Logger::kLogInfo, "LoopGroup: %s", report.c_str());
+    }
+  }
+
+  void stop() override {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    if (!started_ || stopped_) {
+      return ;
+    }
+    stopped_ = true;
+    for (auto& loop : loops_) {
+      Loop* ptr = loop.get();
+      loop->sendQueuedTask([ptr]() -> void {
+        ptr->uninit();
+      });
+    }
+  }
+
+  void join() override {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(threads_mutex_);
+      threads.swap(threads_);
+    }
+    for (auto& thread : threads) {
+      if (thread.get_id() == std::this_thread::get_id()) {
+        // the last reference is released on a loop thread
+        thread.detach();
+      } else {
+        thread.join();
+      }
+    }
+  }
+
+  size_t size() const override {
+    return loops_.size();
+  }
+
+  std::shared_ptr<Loop> getLoop(size_t index) const override {
+    if (index >= loops_.size()) {
+      return nullptr;
+    }
+    return loops_[index];
+  }
+
+  std::shared_ptr<Loop> next() override {
+    size_t count = loops_.size();
+    size_t start = next_index_.fetch_add(1, std::memory_order_relaxed) % count;
+    if (placement_ != kPlacementLeastConnections) {
+      return loops_[start];
+    }
+    // ties go round-robin
+    size_t best = start;
+    size_t best_sockets = loops_[start]->getSocketCount();
+    for (size_t i = 1; (i < count) && best_sockets; i++) {
+      size_t index = (start + i) % count;
+      size_t sockets = loops_[index]->getSocketCount();
+      if (sockets < best_sockets) {
+        best = index;
+        best_sockets = sockets;
+      }
+    }
+    return loops_[best];
+  }
+
+  BasicParams nextParams(const BasicParams& params) override {
+    BasicParams result(params);
+    result.loop = next();
+    return result;
+  }
+
+  std::vector<LoopThreadPlacement> getPlacements() const override {
+    std::lock_guard<std::mutex> lock(placements_mutex_);
+    return placements_;
+  }
+
+  std::string getTopologyReport() const override {
+    std::vector<LoopThreadPlacement> placements(getPlacements());
+    std::string report;
+    report += std::to_string(placements.size()) + " loops, "
+        + std::to_string(topology_.cpus.size()) + " cpus (" + formatCpuList(topology_.cpus) + "), "
+        + std::to_string(topology_.nodes.size()) + " numa nodes\n";
+    for (const auto& placement : placements) {
+      report += "loop " + std::to_string(placement.index) + ": cpus ";
+      report += placement.cpus.empty() ? std::string("any") : formatCpuList(placement.cpus);
+      if (placement.affinity_error) {
+        report += std::string(" (not pinned: ") + uv_strerror(placement.affinity_error) + ")";
+      }
+      report += ", numa node ";
+      report += (placement.numa_node >= 0) ? std::to_string(placement.numa_node) : std::string("unknown");
+      if (numa_memory_ != kNumaMemoryDefault) {
+        report += (numa_memory_ == kNumaMemoryBindLocal) ? ", memory bound" : ", memory preferred";
+        if (placement.memory_error) {
+          report += std::string(" (failed: ") + uv_strerror(placement.memory_error) + ")";
+        }
+      }
+      report += "\n";
+    }
+    return report;
+  }
+};
+
+std::shared_ptr<LoopGroup> LoopGroup::create(const LoopGroupOptions& options) {
+  return std::make_shared<LoopGroupImpl>(options);
+}
+
+} // namespace unio
+} // namespace jcu
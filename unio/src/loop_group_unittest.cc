@@ -0,0 +1,240 @@
+/**
+ * @file	loop_group_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "../test/unit_test_utils.h"
+#include <jcu-unio/loop_group.h>
+#include <jcu-unio/log.h>
+#include <jcu-unio/net/tcp_socket.h>
+#include <jcu-unio/timer.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+TEST(LoopGroupTest, RunOnSeparateThreads) {
+  LoopGroupOptions options;
+  options.threads = 3;
+  auto group = LoopGroup::create(options);
+  ASSERT_EQ(group->size(), 3);
+  group->start();
+
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  std::atomic_int executed(0);
+  for (size_t i = 0; i < group->size(); i++) {
+    group->getLoop(i)->sendQueuedTask([&]() -> void {
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_ids.insert(std::this_thread::get_id());
+      executed++;
+    });
+  }
+  for (int i = 0; (executed.load() < 3) && (i < 100); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+  }
+  EXPECT_EQ(executed.load(), 3);
+  EXPECT_EQ(thread_ids.size(), 3);
+  EXPECT_EQ(thread_ids.count(std::this_thread::get_id()), 0);
+
+  group->stop();
+  group->join();
+}
+
+TEST(LoopGroupTest, RoundRobin) {
+  LoopGroupOptions options;
+  options.threads = 3;
+  auto group = LoopGroup::create(options);
+
+  auto first = group->next();
+  auto second = group->next();
+  auto third = group->next();
+  EXPECT_NE(first, second);
+  EXPECT_NE(second, third);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(group->next(), first);
+}
+
+TEST(LoopGroupTest, LeastConnections) {
+  LoopGroupOptions options;
+  options.threads = 3;
+  options.placement = kPlacementLeastConnections;
+  auto group = LoopGroup::create(options);
+  group->start();
+
+  BasicParams basic_params;
+  basic_params.logger = createDefaultLogger([](Logger::LogLevel level, const std::string& text) -> void {
+  });
+  basic_params.loop = group->getLoop(0);
+
+  std::promise<void> p_inited;
+  std::future<void> f_inited = p_inited.get_future();
+  auto socket = TCPSocket::create(basic_params);
+  socket->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    p_inited.set_value();
+  });
+  ASSERT_EQ(f_inited.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(group->getLoop(0)->getSocketCount(), 1);
+
+  for (int i = 0; i < 6; i++) {
+    EXPECT_NE(group->nextParams(basic_params).loop, group->getLoop(0));
+  }
+
+  std::promise<void> p_closed;
+  std::future<void> f_closed = p_closed.get_future();
+  socket->once<CloseEvent>([&](auto& event, auto& resource) -> void {
+    p_closed.set_value();
+  });
+  basic_params.loop->sendQueuedTask([socket]() -> void {
+    socket->close();
+  });
+  ASSERT_EQ(f_closed.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(group->getLoop(0)->getSocketCount(), 0);
+  socket.reset();
+
+  group->stop();
+  group->join();
+}
+
+TEST(LoopGroupTest, StopWaitsForHandles) {
+  LoopGroupOptions options;
+  options.threads = 2;
+  auto group = LoopGroup::create(options);
+  group->start();
+
+  auto loop = group->getLoop(1);
+  std::atomic_bool closed(false);
+  auto* timer = new uv_timer_t();
+  loop->sendQueuedTask([&, loop, timer]() -> void {
+    uv_timer_init(loop->get(), timer);
+    uv_timer_start(timer, [](uv_timer_t* handle) -> void {
+      std::atomic_bool* closed = (std::atomic_bool*) uv_handle_get_data((uv_handle_t*) handle);
+      closed->store(true);
+      uv_close((uv_handle_t*) handle, [](uv_handle_t* handle) -> void {
+        delete (uv_timer_t*) handle;
+      });
+    }, 100, 0);
+    uv_handle_set_data((uv_handle_t*) timer, &closed);
+  });
+
+  group->stop();
+  group->join();
+  EXPECT_TRUE(closed.load());
+}
+
+TEST(LoopGroupTest, DestroyClosesHandles) {
+  LoopGroupOptions options;
+  options.threads = 2;
+  auto group = LoopGroup::create(options);
+  group->start();
+
+  BasicParams basic_params;
+  basic_params.logger = createDefaultLogger([](Logger::LogLevel level, const std::string& text) -> void {
+  });
+  basic_params.loop = group->getLoop(0);
+
+  std::promise<void> p_listening;
+  std::future<void> f_listening = p_listening.get_future();
+  std::atomic_int closed(0);
+  auto socket = TCPSocket::create(basic_params);
+  socket->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr("127.0.0.1", 0, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    p_listening.set_value();
+  });
+  socket->once<CloseEvent>([&](auto& event, auto& resource) -> void {
+    closed++;
+  });
+  ASSERT_EQ(f_listening.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+
+  basic_params.loop = group->getLoop(1);
+  std::promise<void> p_started;
+  std::future<void> f_started = p_started.get_future();
+  auto timer = Timer::create(basic_params);
+  timer->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<Timer&>(resource);
+    EXPECT_EQ(handle.start(std::chrono::milliseconds { 10 }, std::chrono::milliseconds { 10 }), 0);
+    p_started.set_value();
+  });
+  timer->once<CloseEvent>([&](auto& event, auto& resource) -> void {
+    closed++;
+  });
+  ASSERT_EQ(f_started.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+
+  // the listening socket and the repeating timer keep the loops alive
+  std::promise<void> p_destroyed;
+  std::future<void> f_destroyed = p_destroyed.get_future();
+  std::thread destroyer([&]() -> void {
+    group.reset();
+    p_destroyed.set_value();
+  });
+  EXPECT_EQ(f_destroyed.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  destroyer.join();
+  EXPECT_EQ(closed.load(), 2);
+}
+
+TEST(LoopGroupTest, CpuTopology) {
+  CpuTopology topology = CpuTopology::detect();
+  ASSERT_FALSE(topology.cpus.empty());
+  ASSERT_EQ(topology.cpus.size(), topology.cpu_nodes.size());
+  ASSERT_FALSE(topology.nodes.empty());
+  EXPECT_GE(topology.getNumaNode(topology.cpus[0]), 0);
+  EXPECT_EQ(topology.getNumaNode(-1), -1);
+
+  EXPECT_EQ(formatCpuList({ 8, 0, 1, 2, 3, 10, 11 }), "0-3,8,10-11");
+  EXPECT_EQ(formatCpuList({}), "");
+}
+
+TEST(LoopGroupTest, CpuAffinity) {
+  CpuTopology topology = CpuTopology::detect();
+  LoopGroupOptions options;
+  options.threads = 2;
+  options.affinity = kAffinityCpu;
+  options.numa_memory = kNumaMemoryPreferLocal;
+  std::string logged;
+  options.logger = createDefaultLogger([&](Logger::LogLevel level, const std::string& text) -> void {
+    logged += text;
+  });
+  auto group = LoopGroup::create(options);
+  group->start();
+
+  auto placements = group->getPlacements();
+  ASSERT_EQ(placements.size(), 2);
+  for (size_t i = 0; i < placements.size(); i++) {
+    EXPECT_EQ(placements[i].index, i);
+    ASSERT_EQ(placements[i].cpus.size(), 1);
+    EXPECT_EQ(placements[i].cpus[0], topology.cpus[i % topology.cpus.size()]);
+    EXPECT_EQ(placements[i].numa_node, topology.getNumaNode(placements[i].cpus[0]));
+  }
+#if defined(__linux__)
+  EXPECT_EQ(placements[0].affinity_error, 0);
+
+  std::promise<int> p_cpu;
+  std::future<int> f_cpu = p_cpu.get_future();
+  group->getLoop(0)->sendQueuedTask([&]() -> void {
+    p_cpu.set_value(getCurrentCpu());
+  });
+  EXPECT_EQ(f_cpu.get(), placements[0].cpus[0]);
+#endif
+
+  std::string report = group->getTopologyReport();
+  EXPECT_NE(report.find("loop 1: cpus "), std::string::npos);
+  EXPECT_NE(logged.find("loop 0: cpus "), std::string::npos);
+
+  group->stop();
+  group->join();
+}
+
+} // namespace
@@ -7,8 +7,15 @@
  *            of the Apache License 2.0.  See the LICENSE file for details.
  */
 
+#include <algorithm>
+#include <future>
+#include <string>
+#include <vector>
+
 #include "../test/unit_test_utils.h"
 #include <jcu-unio/loop.h>
+#include <jcu-unio/timer.h>
+#include <jcu-unio/work_pool.h>
 
 namespace {
 
@@ -28,4 +35,332 @@ TEST_F(LoopTest, BasicSendTask) {
   EXPECT_EQ(test_value.load(), 1);
 }
 
+TEST_F(LoopTest, ManyProducers) {
+  const int kProducers = 8;
+  const int kTasks = 10000;
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  // accessed only on the loop thread
+  std::vector<int> last(kProducers, -1);
+  int executed = 0;
+  bool in_order = true;
+
+  std::vector<std::thread> threads;
+  for (int producer = 0; producer < kProducers; producer++) {
+    threads.emplace_back([&, producer]() -> void {
+      for (int i = 0; i < kTasks; i++) {
+        basic_params_.loop->sendQueuedTask([&, producer, i]() -> void {
+          if (last[producer] + 1 != i) {
+            in_order = false;
+          }
+          last[producer] = i;
+          if (++executed == kProducers * kTasks) {
+            p_done.set_value();
+          }
+        });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  EXPECT_TRUE(in_order);
+}
+
+TEST_F(LoopTest, SendFromTask) {
+  std::promise<int> p_done;
+  std::future<int> f_done = p_done.get_future();
+  auto loop = basic_params_.loop;
+  int depth = 0;
+
+  std::function<void()> task = [&]() -> void {
+    if (++depth < 100) {
+      loop->sendQueuedTask([&]() -> void { task(); });
+    } else {
+      p_done.set_value(depth);
+    }
+  };
+  loop->sendQueuedTask([&]() -> void { task(); });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(f_done.get(), 100);
+}
+
+TEST_F(LoopTest, QueuedTaskDoesNotAllocate) {
+  const int kTasks = 1000;
+  auto loop = basic_params_.loop;
+  auto resource = std::make_shared<int>(0);
+  std::atomic_int executed(0);
+
+  auto post = [&](int count) -> void {
+    executed.store(0);
+    for (int i = 0; i < count; i++) {
+      // captures like TCPSocket::read
+      loop->sendQueuedTask([resource, &executed]() -> void {
+        executed.fetch_add(1);
+      });
+    }
+    for (int i = 0; (executed.load() < count) && (i < 5000); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+    }
+  };
+
+  // fills the node pool
+  post(kTasks);
+  ASSERT_EQ(executed.load(), kTasks);
+
+  size_t before = getAllocationCount();
+  post(kTasks);
+  size_t allocations = getAllocationCount() - before;
+  ASSERT_EQ(executed.load(), kTasks);
+  EXPECT_EQ(allocations, 0);
+}
+
+static std::thread::id getLoopThreadId(const std::shared_ptr<Loop>& loop) {
+  std::promise<std::thread::id> p_id;
+  std::future<std::thread::id> f_id = p_id.get_future();
+  loop->sendQueuedTask([&]() -> void {
+    p_id.set_value(std::this_thread::get_id());
+  });
+  return f_id.get();
+}
+
+TEST_F(LoopTest, SubmitWorkOnPool) {
+  auto loop = basic_params_.loop;
+  auto pool = WorkPool::create(2);
+  loop->setWorkPool(pool);
+  std::thread::id loop_thread_id = getLoopThreadId(loop);
+
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  std::thread::id work_thread_id;
+  std::thread::id completion_thread_id;
+  loop->submitWork([&]() -> void {
+    work_thread_id = std::this_thread::get_id();
+  }, [&]() -> void {
+    completion_thread_id = std::this_thread::get_id();
+    p_done.set_value();
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_NE(work_thread_id, loop_thread_id);
+  EXPECT_NE(work_thread_id, std::this_thread::get_id());
+  EXPECT_EQ(completion_thread_id, loop_thread_id);
+  loop->setWorkPool(nullptr);
+}
+
+TEST_F(LoopTest, SubmitWorkWithError) {
+  auto loop = basic_params_.loop;
+
+  // on the libuv threadpool, error is called only if the work was not run
+  std::promise<int> p_done;
+  std::future<int> f_done = p_done.get_future();
+  std::atomic_bool worked(false);
+  loop->submitWork([&]() -> void {
+    worked.store(true);
+  }, [&]() -> void {
+    p_done.set_value(0);
+  }, [&](int status) -> void {
+    p_done.set_value(status);
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(f_done.get(), 0);
+  EXPECT_TRUE(worked.load());
+}
+
+TEST_F(LoopTest, SubmitWorkWithResult) {
+  auto loop = basic_params_.loop;
+  std::thread::id loop_thread_id = getLoopThreadId(loop);
+
+  // on the libuv threadpool
+  std::promise<std::string> p_result;
+  std::future<std::string> f_result = p_result.get_future();
+  std::unique_ptr<int> input(new int(42));
+  loop->submitWork([input = std::move(input)]() -> std::string {
+    return std::to_string(*input);
+  }, [&](std::string&& result) -> void {
+    EXPECT_EQ(std::this_thread::get_id(), loop_thread_id);
+    p_result.set_value(std::move(result));
+  });
+
+  ASSERT_EQ(f_result.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(f_result.get(), "42");
+}
+
+TEST_F(LoopTest, Metrics) {
+  auto loop = basic_params_.loop;
+  loop->enableMetrics();
+  EXPECT_TRUE(loop->isMetricsEnabled());
+
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  // blocks the loop for 20ms
+  loop->sendQueuedTask([&]() -> void {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+  });
+  // some of them are sampled
+  for (int i = 0; i < 16; i++) {
+    loop->sendQueuedTask([]() -> void {});
+  }
+  loop->sendQueuedTask([&]() -> void {
+    p_done.set_value();
+  });
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  // lets a few idle iterations run
+  for (int i = 0; i < 3; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    loop->sendQueuedTask([]() -> void {});
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+
+  LoopMetricsSnapshot metrics = loop->getMetrics();
+  EXPECT_GT(metrics.iterations, 0);
+  EXPECT_EQ(metrics.iteration_time.count, metrics.iterations);
+  EXPECT_GE(metrics.busy_time.max, 20000000);
+  EXPECT_GT(metrics.idle_time.sum, 0);
+  EXPECT_GE(metrics.queued_task_wait.count, 2);
+  // the tasks waited for the first one
+  EXPECT_GE(metrics.queued_task_wait.max, 20000000);
+
+  loop->resetMetrics();
+  std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+  EXPECT_LT(loop->getMetrics().busy_time.max, 20000000);
+}
+
+TEST_F(LoopTest, PostAndDispatch) {
+  auto loop = basic_params_.loop;
+  std::thread::id loop_thread_id = getLoopThreadId(loop);
+  EXPECT_EQ(loop->getThreadId(), loop_thread_id);
+  EXPECT_FALSE(loop->isInLoopThread());
+  EXPECT_EQ(Loop::getCurrent(), nullptr);
+
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  std::vector<int> order;
+  // from another thread, dispatch is queued
+  loop->dispatch([&]() -> void {
+    EXPECT_TRUE(loop->isInLoopThread());
+    EXPECT_EQ(Loop::getCurrent(), loop.get());
+    order.push_back(1);
+    loop->post([&]() -> void {
+      order.push_back(4);
+      p_done.set_value();
+    });
+    // runs before returning
+    loop->dispatch([&]() -> void {
+      order.push_back(2);
+    });
+    order.push_back(3);
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_EQ(order, std::vector<int>({ 1, 2, 3, 4 }));
+}
+
+TEST_F(LoopTest, PriorityLanes) {
+  auto loop = basic_params_.loop;
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  std::vector<int> order;
+
+  // queued from the loop thread, so that all lanes are filled before they are run
+  loop->post([&]() -> void {
+    loop->post([&]() -> void {
+      order.push_back(30);
+      p_done.set_value();
+    }, kTaskPriorityIdle);
+    for (int i = 0; i < 40; i++) {
+      loop->post([&, i]() -> void {
+        order.push_back(10 + (i == 39 ? 1 : 0));
+        if (i == 20) {
+          loop->post([&]() -> void {
+            order.push_back(0);
+          }, kTaskPriorityHigh);
+        }
+      });
+    }
+    loop->post([&]() -> void {
+      order.push_back(0);
+    }, kTaskPriorityHigh);
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  ASSERT_EQ(order.size(), 43);
+  // high first
+  EXPECT_EQ(order[0], 0);
+  // a high task posted by a normal task runs before the rest of the normal lane
+  size_t second_high = std::find(order.begin() + 1, order.end(), 0) - order.begin();
+  EXPECT_LT(second_high, 40);
+  EXPECT_EQ(order[41], 11);
+  // idle last
+  EXPECT_EQ(order[42], 30);
+}
+
+TEST_F(LoopTest, TaskBudget) {
+  QueuedTaskBudget budget;
+  budget.max_tasks = 10;
+  basic_params_.loop->setQueuedTaskBudget(budget);
+  EXPECT_EQ(basic_params_.loop->getQueuedTaskBudget().max_tasks, 10);
+
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  auto loop = basic_params_.loop;
+  int executed = 0;
+
+  loop->sendQueuedTask([&]() -> void {
+    for (int i = 0; i < 100; i++) {
+      loop->sendQueuedTask([&]() -> void {
+        if (++executed == 100) {
+          p_done.set_value();
+        }
+      });
+    }
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the iteration complete
+  QueuedTaskStats stats = loop->getQueuedTaskStats();
+  EXPECT_GE(stats.tasks_run, 101);
+  EXPECT_LE(stats.max_tasks_run, 10);
+  EXPECT_GE(stats.deferred_iterations, 9);
+  EXPECT_GT(stats.deferred_tasks, 0);
+}
+
+TEST_F(LoopTest, TaskDoesNotStarveTimer) {
+  std::promise<void> p_fired;
+  std::future<void> f_fired = p_fired.get_future();
+  std::promise<void> p_stopped;
+  std::future<void> f_stopped = p_stopped.get_future();
+  auto loop = basic_params_.loop;
+  std::atomic_bool fired(false);
+
+  // reposts itself until the timer fires
+  std::function<void()> task = [&]() -> void {
+    if (fired.load()) {
+      p_stopped.set_value();
+      return ;
+    }
+    loop->sendQueuedTask([&]() -> void { task(); });
+  };
+  loop->sendQueuedTask([&]() -> void { task(); });
+
+  auto timer = Timer::create(basic_params_);
+  timer->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    dynamic_cast<Timer&>(resource).start(std::chrono::milliseconds { 10 });
+  });
+  timer->once<TimerEvent>([&](auto& event, auto& resource) -> void {
+    fired.store(true);
+    p_fired.set_value();
+    resource.close();
+  });
+
+  ASSERT_EQ(f_fired.wait_for(std::chrono::milliseconds { 2000 }), std::future_status::ready);
+  ASSERT_EQ(f_stopped.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  EXPECT_GT(loop->getQueuedTaskStats().deferred_iterations, 0);
+  timer.reset();
+}
+
 }
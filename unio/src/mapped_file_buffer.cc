@@ -0,0 +1,146 @@
+/**
+ * @file	mapped_file_buffer.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <jcu-unio/buffer.h>
+
+namespace jcu {
+namespace unio {
+
+#if !defined(_WIN32)
+
+class MappedFileBuffer : public Buffer {
+ protected:
+  void* map_;
+  size_t map_size_;
+  char* buf_;
+  size_t size_;
+  size_t position_;
+  size_t limit_;
+
+ public:
+  MappedFileBuffer(void* map, size_t map_size, char* buf, size_t size) :
+      map_(map),
+      map_size_(map_size),
+      buf_(buf),
+      size_(size),
+      position_(0),
+      limit_(size)
+  {}
+
+  ~MappedFileBuffer() override {
+    ::munmap(map_, map_size_);
+  }
+
+  static std::shared_ptr<MappedFileBuffer> create(const char* path, uint64_t offset, size_t length) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st;
+    if ((::fstat(fd, &st) != 0) || (offset >= (uint64_t) st.st_size)) {
+      ::close(fd);
+      return nullptr;
+    }
+    uint64_t available = (uint64_t) st.st_size - offset;
+    if ((length == 0) || (length > available)) {
+      length = (size_t) available;
+    }
+
+    // mmap offset must be page aligned
+    uint64_t page_size = (uint64_t) ::sysconf(_SC_PAGESIZE);
+    uint64_t map_offset = offset - (offset % page_size);
+    size_t delta = (size_t) (offset - map_offset);
+    size_t map_size = length + delta;
+
+    void* map = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, (off_t) map_offset);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      return nullptr;
+    }
+    ::madvise(map, map_size, MADV_SEQUENTIAL);
+    ::madvise(map, map_size, MADV_WILLNEED);
+
+    return std::make_shared<MappedFileBuffer>(map, map_size, (char*) map + delta, length);
+  }
+
+  void *base() override {
+    return buf_;
+  }
+
+  const void *base() const override {
+    return buf_;
+  }
+
+  void *data() override {
+    return buf_ + position();
+  }
+
+  const void *data() const override {
+    return buf_ + position();
+  }
+
+  size_t capacity() const override {
+    return size_;
+  }
+
+  size_t position() const override {
+    return position_;
+  }
+
+  void position(size_t size) override {
+    position_ = size;
+  }
+
+  void limit(size_t size) override {
+    limit_ = size;
+  }
+
+  size_t remaining() const override {
+    return limit_ - position_;
+  }
+
+  void flip() override {
+    limit_ = position_;
+    position_ = 0;
+  }
+
+  void clear() override {
+    position_ = 0;
+    limit_ = capacity();
+  }
+
+  size_t getExpandableSize() const override {
+    return size_;
+  }
+
+  void expand(size_t /* size */) override {
+  }
+};
+
+std::shared_ptr<Buffer> createMappedFileBuffer(const char* path, uint64_t offset, size_t length) {
+  return MappedFileBuffer::create(path, offset, length);
+}
+
+#else
+
+std::shared_ptr<Buffer> createMappedFileBuffer(const char* path, uint64_t offset, size_t length) {
+  return nullptr;
+}
+
+#endif
+
+} // namespace unio
+} // namespace jcu
@@ -0,0 +1,87 @@
+/**
+ * @file	mpsc_queue.h
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#ifndef JCU_UNIO_SRC_MPSC_QUEUE_H_
+#define JCU_UNIO_SRC_MPSC_QUEUE_H_
+
+#include <atomic>
+
+namespace jcu {
+namespace unio {
+
+struct MpscNode {
+  std::atomic<MpscNode*> next;
+
+  MpscNode() : next(nullptr) {}
+};
+
+/**
+ * Lock-free multi-producer single-consumer queue of intrusive nodes (Vyukov).
+ *
+ * push() is wait-free and can be called from any thread.
+ * pop() must be called from one consumer thread at a time.
+ */
+class MpscQueue {
+ private:
+  std::atomic<MpscNode*> head_;
+  MpscNode* tail_;
+  MpscNode stub_;
+
+ public:
+  MpscQueue() :
+      head_(&stub_),
+      tail_(&stub_)
+  {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void push(MpscNode* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /**
+   * @return nullptr if it is empty,
+   *         or if a producer has not linked its node yet (retry later)
+   */
+  MpscNode* pop() {
+    MpscNode* tail = tail_;
+    MpscNode* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (!next) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    // tail is the last node: put the stub behind it so that it can be taken
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+};
+
+} // namespace unio
+} // namespace jcu
+
+#endif //JCU_UNIO_SRC_MPSC_QUEUE_H_
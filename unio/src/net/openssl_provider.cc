@@ -174,6 +174,8 @@ class OpenSSLEngineImpl : public OpenSSLEngine {
     BIO *app_bio = nullptr;
 
     ssl_.reset(SSL_new(ssl_context_->getNativeCtx()));
+    // wrap() is called repeatedly until the input is consumed
+    SSL_set_mode(ssl_.get(), SSL_MODE_ENABLE_PARTIAL_WRITE);
     if (!hostname_.empty()) {
       SSL_set_tlsext_host_name(ssl_.get(), hostname_.c_str());
     }
@@ -212,37 +214,83 @@ class OpenSSLEngineImpl : public OpenSSLEngine {
     return rv;
   }
 
-  DataResult wrap(Buffer *input, Buffer *output) override {
+  /**
+   * The Buffer bookkeeping below is instantiated for FlatBuffer (see visitBuffer) so it is inlined
+   */
+  template <class T>
+  bool sslWrite(T *input) {
+    int rv = SSL_write(ssl_.get(), input->data(), input->remaining());
+    if (handleError(rv)) {
+      return false;
+    }
+    input->position(input->position() + rv);
+    return true;
+  }
+
+  template <class T>
+  bool bioRead(T *output) {
     int rv = 0;
-    if (input) {
-      rv = SSL_write(ssl_.get(), input->data(), input->remaining());
+    int pending = BIO_pending(app_bio_.get());
+    if (pending > 0) {
+      rv = BIO_read(app_bio_.get(), output->data(), output->remaining());
       if (handleError(rv)) {
-        return kDataClosed;
+        return false;
+      }
+    }
+    output->position(output->position() + rv);
+    output->flip();
+    return true;
+  }
+
+  template <class T>
+  bool bioWrite(T *input) {
+    if (input->remaining() > 0) {
+      int rv = BIO_write(app_bio_.get(), input->data(), input->remaining());
+      if (handleError(rv)) {
+        return false;
       }
       input->position(input->position() + rv);
     }
+    return true;
+  }
+
+  template <class T>
+  bool sslRead(T *output) {
+    int rv = SSL_read(ssl_.get(), output->data(), output->remaining());
+    if (handleError(rv)) {
+      return false;
+    }
+    output->position(output->position() + rv);
+    output->flip();
+    return true;
+  }
+
+  DataResult wrap(Buffer *input, Buffer *output) override {
+    if (input) {
+      if (!visitBuffer(input, [this](auto *input) -> bool { return sslWrite(input); })) {
+        return kDataClosed;
+      }
+    }
     if (output) {
-      int pending = BIO_pending(app_bio_.get());
-      if (pending > 0) {
-        rv = BIO_read(app_bio_.get(), output->data(), output->remaining());
-        if (handleError(rv)) {
-          return kDataClosed;
-        }
+      if (!visitBuffer(output, [this](auto *output) -> bool { return bioRead(output); })) {
+        return kDataClosed;
       }
-      output->position(output->position() + rv);
-      output->flip();
     }
     return kDataOk;
   }
 
+  size_t getOutboundPending() const override {
+    if (!app_bio_) {
+      return 0;
+    }
+    return BIO_ctrl_pending(app_bio_.get());
+  }
+
   DataResult unwrap(Buffer *input, Buffer *output) override {
-    int rv = 0;
-    if (input && input->remaining() > 0) {
-      rv = BIO_write(app_bio_.get(), input->data(), input->remaining());
-      if (handleError(rv)) {
+    if (input) {
+      if (!visitBuffer(input, [this](auto *input) -> bool { return bioWrite(input); })) {
         return kDataClosed;
       }
-      input->position(input->position() + rv);
     }
     if (!SSL_is_init_finished(ssl_.get())) {
       if (doHandshake() != 1) {
@@ -250,14 +298,11 @@ class OpenSSLEngineImpl : public OpenSSLEngine {
       }
     }
     if (output) {
-      rv = SSL_read(ssl_.get(), output->data(), output->remaining());
-      if (handleError(rv)) {
+      if (!visitBuffer(output, [this](auto *output) -> bool { return sslRead(output); })) {
         return kDataClosed;
       }
-      output->position(output->position() + rv);
-      output->flip();
 
-      rv = SSL_pending(ssl_.get());
+      int rv = SSL_pending(ssl_.get());
       if (rv > 0) {
         return (DataResult)(kDataRead | kDataReadMore);
       }
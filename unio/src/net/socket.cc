@@ -15,10 +15,21 @@ namespace jcu {
 namespace unio {
 
 SocketReadEvent::SocketReadEvent(Buffer *buffer) :
-    AbstractEvent(nullptr), buffer_(buffer) {}
+    AbstractEvent(nullptr), buffer_(buffer), retained_(false) {}
 
 SocketReadEvent::SocketReadEvent(std::shared_ptr<ErrorEvent> error, Buffer *buffer) :
-    AbstractEvent(std::move(error)), buffer_(buffer) {}
+    AbstractEvent(std::move(error)), buffer_(buffer), retained_(false) {}
+
+SocketReadEvent::SocketReadEvent(std::shared_ptr<Buffer> buffer) :
+    AbstractEvent(nullptr), buffer_(buffer.get()), owner_(std::move(buffer)), retained_(false) {}
+
+BufferSlice SocketReadEvent::retain() {
+  if (!owner_) {
+    return {};
+  }
+  retained_ = true;
+  return BufferSlice(owner_, buffer_->data(), buffer_->remaining());
+}
 
 SocketWriteEvent::SocketWriteEvent() :
     AbstractEvent(nullptr) {}
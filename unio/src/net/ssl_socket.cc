@@ -9,7 +9,10 @@
 
 #include <uv/errno.h>
 
+#include <algorithm>
+
 #include <jcu-unio/log.h>
+#include <jcu-unio/buffer_pool.h>
 #include <jcu-unio/net/ssl_socket.h>
 #include <jcu-unio/net/ssl_context.h>
 
@@ -20,6 +23,19 @@ class Logger;
 
 class SSLSocketImpl : public SSLSocket {
  public:
+  /**
+   * maximum TLS record size
+   */
+  static const size_t kDefaultReadBufferSize = 16384;
+  /**
+   * maximum size of a buffer of outbound TLS records, they are sized by SSLEngine::getOutboundPending
+   */
+  static const size_t kOutboundChunkSize = 16384;
+  /**
+   * completed PendingWrites kept for the next writes
+   */
+  static const size_t kMaxFreePendingWrites = 4;
+
   std::weak_ptr<SSLSocketImpl> self_;
 
   std::shared_ptr<jcu::unio::StreamSocket> parent_;
@@ -30,6 +46,19 @@ class SSLSocketImpl : public SSLSocket {
 
   CompletionOnceCallback<jcu::unio::SocketConnectEvent> connect_event_;
 
+  /**
+   * User callback and TLS records of a write in flight on the parent.
+   * The parent's callback captures only a pointer to it, so that it is stored without allocation.
+   * The record buffers stay with it when it is recycled, so that a steady-state write does not allocate.
+   */
+  struct PendingWrite {
+    CompletionOnceCallback<SocketWriteEvent> callback;
+    BufferChain outbound;
+    PendingWrite* next;
+  };
+  PendingWrite* free_pending_writes_;
+  size_t free_pending_write_count_;
+
   std::shared_ptr<Buffer> socket_inbound_buffer_;
 
   bool handshaked_;
@@ -39,13 +68,20 @@ class SSLSocketImpl : public SSLSocket {
       ssl_context_(ssl_context),
       handshaked_(false),
       closing_(false),
-      connect_event_(nullptr)
+      connect_event_(nullptr),
+      free_pending_writes_(nullptr),
+      free_pending_write_count_(0)
   {
     basic_params_ = basic_params;
     basic_params_.logger->logf(Logger::kLogTrace, "SSLSocketImpl construct");
   }
 
   ~SSLSocketImpl() {
+    while (free_pending_writes_) {
+      PendingWrite* next = free_pending_writes_->next;
+      delete free_pending_writes_;
+      free_pending_writes_ = next;
+    }
     basic_params_.logger->logf(Logger::kLogTrace, "SSLSocketImpl destruct");
   }
 
@@ -74,6 +110,17 @@ class SSLSocketImpl : public SSLSocket {
       self->emit<CloseEvent>(event);
       self->offAll();
     });
+    parent_->on<SocketPressureEvent>([self](SocketPressureEvent& event, Resource& handle) -> void {
+      self->emit<SocketPressureEvent>(event);
+    });
+    parent_->on<SocketEndEvent>([self](SocketEndEvent& event, Resource& handle) -> void {
+      StreamSink* sink = self->sink_.get();
+      if (sink) {
+        sink->onEnd();
+      } else {
+        self->emit<SocketEndEvent>(event);
+      }
+    });
     parent_->on<SocketReadEvent>([self](SocketReadEvent& event, Resource& handle) -> void {
       if (event.hasError()) {
         self->emit<SocketReadEvent>(event);
@@ -81,15 +128,34 @@ class SSLSocketImpl : public SSLSocket {
         return ;
       }
       SSLEngine::DataResult result;
-      Buffer* inbound_buffer;
+      std::shared_ptr<Buffer> inbound_buffer;
       do {
-        inbound_buffer = self->socket_inbound_buffer_.get();
+        inbound_buffer = self->socket_inbound_buffer_;
         if (inbound_buffer) inbound_buffer->clear();
-        result = self->ssl_engine_->unwrap(event.buffer(), inbound_buffer);
+        result = self->ssl_engine_->unwrap(event.buffer(), inbound_buffer.get());
         if (result & SSLEngine::kDataRead) {
           if (inbound_buffer && inbound_buffer->remaining() > 0) {
+            StreamSink* sink = self->sink_.get();
+            if (sink) {
+              sink->onRead(*inbound_buffer);
+              continue;
+            }
             SocketReadEvent event {inbound_buffer};
             self->emit<SocketReadEvent>(event);
+            if (event.isRetained() && (self->socket_inbound_buffer_ == inbound_buffer)) {
+              self->socket_inbound_buffer_ = createExpandableBuffer(
+                  self->basic_params_,
+                  inbound_buffer->capacity(),
+                  inbound_buffer->getExpandableSize(),
+                  kBufferTls
+              );
+              if (!self->socket_inbound_buffer_) {
+                // over the buffer budget
+                self->emit<ErrorEvent>(*UvErrorEvent::createIfNeeded(UV__ENOBUFS));
+                self->close();
+                return ;
+              }
+            }
           }
         }
       } while(inbound_buffer && (result & SSLEngine::kDataReadMore));
@@ -102,6 +168,13 @@ class SSLSocketImpl : public SSLSocket {
   }
 
   void read(std::shared_ptr<Buffer> buffer) override {
+    if (!buffer) {
+      buffer = createFixedSizeBuffer(basic_params_, kDefaultReadBufferSize, kBufferTls);
+      if (!buffer) {
+        emit<ErrorEvent>(*UvErrorEvent::createIfNeeded(UV__ENOBUFS));
+        return ;
+      }
+    }
     socket_inbound_buffer_ = buffer;
   }
 
@@ -109,13 +182,125 @@ class SSLSocketImpl : public SSLSocket {
     socket_inbound_buffer_ = nullptr;
   }
 
+  void emitWriteEvent(CompletionOnceCallback<SocketWriteEvent>& callback, SocketWriteEvent& event) {
+    if (callback) {
+      callback(event, *this);
+    } else if (sink_) {
+      sink_->onWriteComplete(event.hasError() ? event.error().code() : 0);
+    } else {
+      if (event.hasError()) {
+        emit<ErrorEvent>(event.error());
+      } else {
+        emit<SocketWriteEvent>(event);
+      }
+    }
+  }
+
+  PendingWrite* acquirePendingWrite() {
+    PendingWrite* pending = free_pending_writes_;
+    if (!pending) {
+      return new PendingWrite();
+    }
+    free_pending_writes_ = pending->next;
+    free_pending_write_count_--;
+    return pending;
+  }
+
+  void releasePendingWrite(PendingWrite* pending) {
+    if (free_pending_write_count_ >= kMaxFreePendingWrites) {
+      delete pending;
+      return ;
+    }
+    pending->next = free_pending_writes_;
+    free_pending_writes_ = pending;
+    free_pending_write_count_++;
+  }
+
+  /**
+   * Move all pending TLS records into outbound from index count,
+   * reusing the buffers already there
+   *
+   * @return 0 or uv error code
+   */
+  int drainOutbound(BufferChain& outbound, size_t& count) {
+    for (;;) {
+      size_t pending = ssl_engine_->getOutboundPending();
+      if (!pending) {
+        return 0;
+      }
+      size_t size = std::min(pending, kOutboundChunkSize);
+      Buffer* chunk = nullptr;
+      if (count < outbound.size()) {
+        // the write of the PendingWrite completed before it was recycled
+        chunk = outbound[count].get();
+        chunk->expand(size);
+      }
+      if (!chunk || (chunk->capacity() < size)) {
+        auto buffer = createExpandableBuffer(basic_params_, size, kOutboundChunkSize, kBufferTls);
+        if (!buffer) {
+          return UV__ENOBUFS;
+        }
+        chunk = buffer.get();
+        if (count < outbound.size()) {
+          outbound[count] = std::move(buffer);
+        } else {
+          outbound.emplace_back(std::move(buffer));
+        }
+      }
+      chunk->clear();
+      if ((ssl_engine_->wrap(nullptr, chunk) == SSLEngine::kDataClosed) || !chunk->remaining()) {
+        return UV__EPROTO;
+      }
+      count++;
+    }
+  }
+
   void write(std::shared_ptr<Buffer> buffer, CompletionOnceCallback<SocketWriteEvent> callback) override {
+    writeBuffers(&buffer, 1, std::move(callback));
+  }
+
+  void write(const BufferChain& buffers, CompletionOnceCallback<SocketWriteEvent> callback) override {
+    writeBuffers(buffers.data(), buffers.size(), std::move(callback));
+  }
+
+  void writeBuffers(const std::shared_ptr<Buffer>* buffers, size_t buffer_count, CompletionOnceCallback<SocketWriteEvent> callback) {
     std::shared_ptr<SSLSocketImpl> self(self_.lock());
-    socket_outbound_buffer_->clear();
-    int rc = ssl_engine_->wrap(buffer.get(), socket_outbound_buffer_.get());
-    //TODO: partial write
-    parent_->write(socket_outbound_buffer_, [self, callback = std::move(callback)](SocketWriteEvent& event, Resource& handle) mutable -> void {
-      callback(event, *self);
+    PendingWrite* pending = acquirePendingWrite();
+    size_t count = 0;
+    for (size_t i = 0; i < buffer_count; i++) {
+      Buffer* buffer = buffers[i].get();
+      while (buffer->remaining() > 0) {
+        size_t position = buffer->position();
+        if ((ssl_engine_->wrap(buffer, nullptr) == SSLEngine::kDataClosed) || (buffer->position() == position)) {
+          releasePendingWrite(pending);
+          std::shared_ptr<ErrorEvent> error(ssl_engine_->getHandshakeError());
+          SocketWriteEvent event { error ? error : UvErrorEvent::createIfNeeded(UV__EPROTO) };
+          emitWriteEvent(callback, event);
+          return ;
+        }
+        int rc = drainOutbound(pending->outbound, count);
+        if (rc) {
+          releasePendingWrite(pending);
+          SocketWriteEvent event { UvErrorEvent::createIfNeeded(rc) };
+          emitWriteEvent(callback, event);
+          return ;
+        }
+      }
+    }
+    if (!count) {
+      releasePendingWrite(pending);
+      // nothing to send, like a zero-length write on the parent
+      SocketWriteEvent event;
+      emitWriteEvent(callback, event);
+      return ;
+    }
+    // buffers left over from a larger write
+    pending->outbound.resize(count);
+    pending->callback = std::move(callback);
+    parent_->write(pending->outbound, [self, pending](SocketWriteEvent& event, Resource& handle) -> void {
+      CompletionOnceCallback<SocketWriteEvent> callback(std::move(pending->callback));
+      self->releasePendingWrite(pending);
+      self->emitWriteEvent(callback, event);
     });
   }
 
@@ -149,7 +334,13 @@ class SSLSocketImpl : public SSLSocket {
       if (hostname) self->ssl_engine_->setHostname(hostname);
       self->ssl_engine_->beginHandshake();
 
-      auto buffer = createFixedSizeBuffer(8192);
+      auto buffer = createFixedSizeBuffer(self->basic_params_, 8192, kBufferTls);
+      if (!buffer) {
+        SocketConnectEvent event { UvErrorEvent::createIfNeeded(UV__ENOBUFS) };
+        self->emitConnectEvent(self->connect_event_, event);
+        self->connect_event_ = nullptr;
+        return ;
+      }
       self->parent_->read(buffer);
       self->tlsProcess();
     });
@@ -170,7 +361,15 @@ class SSLSocketImpl : public SSLSocket {
     switch (status) {
       case SSLEngine::kHandshakeNeedWrap:
         if (!socket_outbound_buffer_) {
-          socket_outbound_buffer_ = createFixedSizeBuffer(8192);
+          socket_outbound_buffer_ = createFixedSizeBuffer(basic_params_, 8192, kBufferTls);
+          if (!socket_outbound_buffer_) {
+            if (connect_event_) {
+              SocketConnectEvent event { UvErrorEvent::createIfNeeded(UV__ENOBUFS) };
+              emitConnectEvent(connect_event_, event);
+              connect_event_ = nullptr;
+            }
+            break;
+          }
         }
         socket_outbound_buffer_->clear();
         rc = ssl_engine_->wrap(nullptr, socket_outbound_buffer_.get());
@@ -254,6 +453,9 @@ class SSLSocketImpl : public SSLSocket {
   }
 };
 
+const size_t SSLSocketImpl::kOutboundChunkSize;
+const size_t SSLSocketImpl::kMaxFreePendingWrites;
+
 std::shared_ptr<SSLSocket> SSLSocket::create(
     const BasicParams& basic_params,
     std::shared_ptr<SSLContext> ssl_context
@@ -9,7 +9,9 @@
 
 #include <jcu-unio/loop.h>
 #include <jcu-unio/log.h>
+#include <jcu-unio/small_vector.h>
 #include <jcu-unio/uv_helper.h>
+#include <jcu-unio/buffer_pool.h>
 #include <jcu-unio/net/tcp_socket.h>
 
 namespace jcu {
@@ -17,6 +19,8 @@ namespace unio {
 
 class TCPSocketImpl : public TCPSocket {
  public:
+  static const size_t kDefaultReadBufferSize = 65536;
+
   typedef UvCallbackRef<uv_connect_t, SocketConnectEvent, TCPSocketImpl> ConnectCallbackRef;
   typedef UvCallbackRef<uv_shutdown_t, SocketDisconnectEvent, TCPSocketImpl> ShutdownCallbackRef;
 
@@ -26,29 +30,55 @@ class TCPSocketImpl : public TCPSocket {
     void close() override {
       data_.reset();
     }
+    void forceClose() override {
+      data_->close();
+    }
     void setData(std::shared_ptr<TCPSocketImpl> data) {
       data_ = data;
     }
   };
+  /**
+   * completed WriteRefs kept for the next writes
+   */
+  static const size_t kMaxFreeWriteRefs = 4;
+
   class WriteRef : public UvCallbackRef<uv_write_t, SocketWriteEvent, TCPSocketImpl> {
    public:
     uv_buf_t buf;
+    std::vector<uv_buf_t> bufs;
+    /**
+     * keep the written buffers alive until the write completes
+     * (e.g. the only reference to a BufferSlice::asBuffer() or a mapped file)
+     */
+    BufferChain buffers;
     WriteRef(std::shared_ptr<TCPSocketImpl> data) :
         UvCallbackRef(data)
     {
       std::memset(&buf, 0, sizeof(buf));
     }
-//    void close() override {
-//      data_.reset();
-//    }
-//    void setData(std::shared_ptr<TCPSocketImpl> data) {
-//      data_ = data;
-//    }
-//    void publishOnce(SocketWriteEvent& event) {
-//      publish(event);
-//      fn_ = nullptr;
-//    }
+    /**
+     * Return it to the socket instead of deleting it.
+     * The vectors keep their capacity, so that a steady-state write does not allocate.
+     */
+    void close() override {
+      std::shared_ptr<TCPSocketImpl> self(std::move(data_));
+      fn_ = nullptr;
+      buffers.clear();
+      bufs.clear();
+      std::memset(&handle_, 0, sizeof(handle_));
+      if (self && (self->free_write_refs_.size() < kMaxFreeWriteRefs)) {
+        self->free_write_refs_.emplace_back(this);
+        return ;
+      }
+      delete this;
+    }
     static WriteRef* create(std::shared_ptr<TCPSocketImpl> data) {
+      if (data && !data->free_write_refs_.empty()) {
+        WriteRef* ref = data->free_write_refs_.back();
+        data->free_write_refs_.pop_back();
+        ref->data_ = std::move(data);
+        return ref;
+      }
       return new WriteRef(data);
     }
     static WriteRef* from(void* handle) {
@@ -60,11 +90,32 @@ class TCPSocketImpl : public TCPSocket {
   std::weak_ptr<TCPSocketImpl> self_;
 
   HandleRef handle_;
+  SmallVector<WriteRef*, kMaxFreeWriteRefs> free_write_refs_;
   std::shared_ptr<Buffer> read_buffer_;
+  /**
+   * read_buffer_ if it is a RingBuffer
+   */
+  RingBuffer* read_ring_buffer_;
+  /**
+   * read_buffer_ if it is a FlatBuffer
+   */
+  FlatBuffer* read_flat_buffer_;
+  /**
+   * between read() and cancelRead()
+   */
+  bool reading_;
+  /**
+   * reading is stopped until the buffer budget is relieved
+   */
+  bool read_paused_;
 
   bool connected_;
 
   TCPSocketImpl(const BasicParams& basic_params) :
+      read_ring_buffer_(nullptr),
+      read_flat_buffer_(nullptr),
+      reading_(false),
+      read_paused_(false),
       connected_(false)
   {
     basic_params_ = basic_params;
@@ -72,6 +123,9 @@ class TCPSocketImpl : public TCPSocket {
   }
 
   ~TCPSocketImpl() {
+    for (WriteRef* ref : free_write_refs_) {
+      delete ref;
+    }
     basic_params_.logger->logf(jcu::unio::Logger::kLogTrace, "TCPSocketImpl: destruct");
   }
 
@@ -89,6 +143,7 @@ class TCPSocketImpl : public TCPSocket {
     if (rc == 0) {
       handle_.setData(self_.lock());
       handle_.attach();
+      basic_params_.loop->attachSocket();
     }
     InitEvent event { UvErrorEvent::createIfNeeded(rc) };
     emitInit(std::move(event));
@@ -98,6 +153,7 @@ class TCPSocketImpl : public TCPSocket {
     auto* ref = HandleRef::from(handle);
     std::shared_ptr<TCPSocketImpl> self = ref->data();
     self->basic_params_.logger->logf(jcu::unio::Logger::kLogTrace, "TCPSocketImpl: closeCallback");
+    self->basic_params_.loop->detachSocket();
     CloseEvent event {};
     self->emit<CloseEvent>(event);
     self->offAll();
@@ -120,7 +176,26 @@ class TCPSocketImpl : public TCPSocket {
   {
     auto* ref = HandleRef::from(handle);
     auto self = ref->data();
-    std::shared_ptr<Buffer> buffer = self->read_buffer_;
+    RingBuffer* ring_buffer = self->read_ring_buffer_;
+    if (ring_buffer) {
+      // the kernel reads straight into the free region after unconsumed data
+      buf->base = (char*) ring_buffer->writableData();
+      buf->len = ring_buffer->writable();
+      return ;
+    }
+    FlatBuffer* flat_buffer = self->read_flat_buffer_;
+    if (flat_buffer) {
+      prepareRead(flat_buffer, suggested_size, buf);
+    } else {
+      prepareRead(self->read_buffer_.get(), suggested_size, buf);
+    }
+  }
+
+  /**
+   * Called with FlatBuffer so that the bookkeeping is inlined
+   */
+  template <class T>
+  static void prepareRead(T* buffer, size_t suggested_size, uv_buf_t* buf) {
     buffer->clear();
     size_t buffer_remaining = buffer->remaining();
     if (buffer_remaining < suggested_size) {
@@ -141,40 +216,189 @@ class TCPSocketImpl : public TCPSocket {
   {
     auto* ref = HandleRef::from(stream);
     auto self = ref->data();
-    auto buffer = self->read_buffer_;
+    StreamSink* sink = self->sink_.get();
     if (nread == UV_EOF) {
+      if (sink) {
+        sink->onEnd();
+        return ;
+      }
       SocketEndEvent event;
       self->emit(event);
       return ;
     } else if (nread < 0) {
+      if ((nread == UV_ENOBUFS) && self->stopReadIfRingFull()) {
+        // read() was called with a full RingBuffer
+        return ;
+      }
       auto error_event = UvErrorEvent::createIfNeeded(nread, 0);
       self->emit<ErrorEvent>(*error_event);
       return;
     }
-    buffer->limit(buffer->position() + nread);
-    {
-      SocketReadEvent event { buffer.get() };
-      self->emit<SocketReadEvent>(event);
+    RingBuffer* ring_buffer = self->read_ring_buffer_;
+    FlatBuffer* flat_buffer = self->read_flat_buffer_;
+    // held during the delivery: it may be replaced or released by read(), cancelRead() or close()
+    std::shared_ptr<Buffer> buffer(self->read_buffer_);
+    if (ring_buffer) {
+      ring_buffer->commit(nread);
+    } else if (flat_buffer) {
+      flat_buffer->limit(flat_buffer->position() + nread);
+    } else {
+      buffer->limit(buffer->position() + nread);
     }
-    buffer->clear();
+    if (sink) {
+      // no event and no listener lookup
+      sink->onRead(*buffer);
+      if (!ring_buffer) {
+        buffer->clear();
+      }
+      if (self->reading_ && !self->read_paused_ && !self->stopReadIfRingFull() && self->needsReadPause()) {
+        self->pauseRead();
+      }
+      return ;
+    }
+    SocketReadEvent event { buffer };
+    self->emit<SocketReadEvent>(event);
+    if (event.isRetained()) {
+      self->renewReadBuffer(buffer);
+    } else if (!ring_buffer) {
+      buffer->clear();
+    }
+    if (self->reading_ && !self->read_paused_ && !self->stopReadIfRingFull() && self->needsReadPause()) {
+      self->pauseRead();
+    }
+  }
+
+  /**
+   * Replace the read buffer retained by a listener with a new one of the same kind
+   */
+  void renewReadBuffer(const std::shared_ptr<Buffer>& retained) {
+    if (read_buffer_ != retained) {
+      // read() was called with another buffer in the listener
+      return ;
+    }
+    std::shared_ptr<Buffer> buffer;
+    if (read_ring_buffer_) {
+      buffer = createRingBuffer(basic_params_, retained->capacity(), kBufferRead);
+    }
+    if (!buffer) {
+      buffer = createExpandableBuffer(basic_params_, retained->capacity(), retained->getExpandableSize(), kBufferRead);
+    }
+    // if it is over the buffer budget, reading is paused and a buffer is allocated when it is resumed
+    setReadBuffer(std::move(buffer));
+  }
+
+  void setReadBuffer(std::shared_ptr<Buffer> buffer) {
+    read_ring_buffer_ = dynamic_cast<RingBuffer*>(buffer.get());
+    read_flat_buffer_ = FlatBuffer::from(buffer.get());
+    read_buffer_ = std::move(buffer);
   }
 
   void read(std::shared_ptr<Buffer> buffer) override {
     std::shared_ptr<TCPSocketImpl> self(self_.lock());
-    read_buffer_ = buffer;
-    basic_params_.loop->sendQueuedTask([self]() -> void {
+    if (!buffer) {
+      buffer = createFixedSizeBuffer(basic_params_, kDefaultReadBufferSize, kBufferRead);
+    }
+    setReadBuffer(buffer);
+    reading_ = true;
+    read_paused_ = false;
+    basic_params_.loop->dispatch([self]() -> void {
+      if (!self->reading_ || self->read_paused_) {
+        return ;
+      }
+      if (self->needsReadPause()) {
+        self->pauseRead();
+        return ;
+      }
       uv_read_start(self->handle_.handle<uv_stream_t>(), allocCallback, readCallback);
     });
   }
 
   void cancelRead() override {
     uv_read_stop(handle_.handle<uv_stream_t>());
-    read_buffer_.reset();
+    reading_ = false;
+    read_paused_ = false;
+    setReadBuffer(nullptr);
+  }
+
+  /**
+   * Stop reading when the RingBuffer has no room left for the kernel,
+   * instead of letting libuv fail every read with UV_ENOBUFS.
+   * read() starts it again after the data is consumed.
+   *
+   * @return true if reading is stopped
+   */
+  bool stopReadIfRingFull() {
+    if (!read_ring_buffer_ || (read_ring_buffer_->writable() > 0)) {
+      return false;
+    }
+    uv_read_stop(handle_.handle<uv_stream_t>());
+    reading_ = false;
+    return true;
+  }
+
+  /**
+   * @return true if the buffer budget is under pressure or there is no read buffer because of it
+   */
+  bool needsReadPause() const {
+    const auto& budget = basic_params_.buffer_budget;
+    return budget && (!read_buffer_ || budget->isUnderPressure());
+  }
+
+  /**
+   * Stop reading until the buffer budget is relieved,
+   * so that the peer is throttled by TCP flow control
+   */
+  void pauseRead() {
+    uv_read_stop(handle_.handle<uv_stream_t>());
+    read_paused_ = true;
+    waitForBufferBudget();
+    SocketPressureEvent event { true };
+    emit(event);
+  }
+
+  void waitForBufferBudget() {
+    std::weak_ptr<TCPSocketImpl> weak_self(self_);
+    std::shared_ptr<Loop> loop = basic_params_.loop;
+    basic_params_.buffer_budget->waitForRelief([weak_self, loop]() -> void {
+      // called on the thread that released a buffer.
+      // high priority: the stalled socket resumes before the backlog of normal tasks
+      loop->post([weak_self]() -> void {
+        auto self = weak_self.lock();
+        if (self) {
+          self->resumeRead();
+        }
+      }, kTaskPriorityHigh);
+    });
+  }
+
+  void resumeRead() {
+    if (!read_paused_) {
+      return ;
+    }
+    if (!read_buffer_) {
+      setReadBuffer(createFixedSizeBuffer(basic_params_, kDefaultReadBufferSize, kBufferRead));
+    }
+    if (needsReadPause()) {
+      waitForBufferBudget();
+      return ;
+    }
+    read_paused_ = false;
+    SocketPressureEvent event { false };
+    emit(event);
+    if (reading_ && !read_paused_) {
+      uv_read_start(handle_.handle<uv_stream_t>(), allocCallback, readCallback);
+    }
   }
 
   static void writeCallback(uv_write_t* req, int status) {
     auto ref = WriteRef::from(req);
     std::shared_ptr<TCPSocketImpl> self(ref->data());
+    StreamSink* sink = self->sink_.get();
+    if (sink && !ref->hasCallback()) {
+      ref->close();
+      sink->onWriteComplete(status);
+      return ;
+    }
     SocketWriteEvent event { UvErrorEvent::createIfNeeded(status, 0) };
     ref->publishAndClose(event);
   }
@@ -183,14 +407,41 @@ class TCPSocketImpl : public TCPSocket {
     auto ref = WriteRef::create(self_.lock());
     ref->buf.base = (char*)buffer->data();
     ref->buf.len = buffer->remaining();
-    ref->reset(
+    ref->buffers.emplace_back(std::move(buffer));
+    if (!ref->reset(
         std::move(callback),
         &uv_write,
         handle_.handle<uv_stream_t>(),
         &ref->buf,
         1,
         writeCallback
-    );
+    )) {
+      ref->close();
+    }
+  }
+
+  void write(const BufferChain& buffers, CompletionOnceCallback<SocketWriteEvent> callback) override {
+    auto ref = WriteRef::create(self_.lock());
+    if (buffers.empty()) {
+      ref->setCallback(std::move(callback));
+      ref->publishAndClose(SocketWriteEvent { UvErrorEvent::createIfNeeded(UV_EINVAL, 0) });
+      return ;
+    }
+    ref->buffers = buffers;
+    ref->bufs.reserve(buffers.size());
+    for (const auto& buffer : buffers) {
+      ref->bufs.push_back(uv_buf_init((char*) buffer->data(), buffer->remaining()));
+    }
+    if (!ref->reset(
+        std::move(callback),
+        &uv_write,
+        handle_.handle<uv_stream_t>(),
+        ref->bufs.data(),
+        (unsigned int) ref->bufs.size(),
+        writeCallback
+    )) {
+      ref->close();
+    }
   }
 
   static void connectCallback(uv_connect_t* handle, int status) {
@@ -259,7 +510,7 @@ class TCPSocketImpl : public TCPSocket {
 std::shared_ptr<TCPSocket> TCPSocket::create(const BasicParams& basic_params) {
   auto instance = std::make_shared<TCPSocketImpl>(basic_params);
   instance->self_ = instance;
-  basic_params.loop->sendQueuedTask([instance]() -> void {
+  basic_params.loop->dispatch([instance]() -> void {
     instance->init();
   });
   return std::move(instance);
@@ -9,10 +9,13 @@
 
 #include <future>
 #include <list>
+#include <vector>
 
 #include "../test/unit_test_utils.h"
 #include <jcu-unio/loop.h>
 
+#include <jcu-unio/buffer_budget.h>
+#include <jcu-unio/buffer_pool.h>
 #include <jcu-unio/net/tcp_socket.h>
 
 namespace {
@@ -21,8 +24,123 @@ using namespace jcu::unio;
 
 class TcpSocketTest : public LoopSupportTest {
  public:
+  /**
+   * Write buffers from a client to an accepted socket
+   *
+   * @param port           listen port
+   * @param buffers        data to write
+   * @param read_buffer    read buffer of the accepted socket
+   * @param expected_size  bytes to receive before closing
+   * @param retain         retain the read data instead of copying it
+   * @return received data
+   */
+  std::string transfer(
+      unsigned int port,
+      BufferChain buffers,
+      std::shared_ptr<Buffer> read_buffer,
+      size_t expected_size,
+      bool retain = false
+  );
 };
 
+std::string TcpSocketTest::transfer(
+    unsigned int port,
+    BufferChain buffers,
+    std::shared_ptr<Buffer> read_buffer,
+    size_t expected_size,
+    bool retain
+) {
+  std::promise<std::string> p_received;
+  std::future<std::string> f_received = p_received.get_future();
+  std::promise<int> p_close;
+  std::future<int> f_close = p_close.get_future();
+  std::atomic_int write_completions(0);
+  std::string received;
+  std::vector<BufferSlice> slices;
+  size_t received_size = 0;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+
+  const std::string address = "127.99.88.77";
+
+  server->on<CloseEvent>([&](auto& event, auto& resource) -> void {
+    p_close.set_value(1);
+  });
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    socket->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+      auto* buffer = event.buffer();
+      received_size += buffer->remaining();
+      if (retain) {
+        slices.emplace_back(event.retain());
+      } else {
+        received.append((const char*) buffer->data(), buffer->remaining());
+        buffer->position(buffer->position() + buffer->remaining());
+      }
+      if (received_size >= expected_size) {
+        for (const auto& slice : slices) {
+          received.append((const char*) slice.data(), slice.size());
+        }
+        p_received.set_value(received);
+        resource.close();
+      }
+    });
+    server.accept(socket);
+    socket->read(read_buffer);
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    handle.write(buffers, [&](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      write_completions.fetch_add(1);
+      resource.close();
+    });
+  });
+
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  EXPECT_EQ(f_received.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  EXPECT_EQ(f_close.wait_for(std::chrono::milliseconds { 1000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(write_completions.load(), 1);
+  EXPECT_EQ(server.use_count(), 1);
+  EXPECT_EQ(client.use_count(), 1);
+
+  if (f_received.wait_for(std::chrono::milliseconds { 0 }) != std::future_status::ready) {
+    return {};
+  }
+  return f_received.get();
+}
+
+static std::shared_ptr<Buffer> createStringBuffer(const std::string& text) {
+  auto buffer = createFixedSizeBuffer(text.size());
+  std::memcpy(buffer->data(), text.data(), text.size());
+  buffer->position(text.size());
+  buffer->flip();
+  return buffer;
+}
+
 TEST_F(TcpSocketTest, ConnectSuccess) {
   std::list<int> ran_order;
 
@@ -96,15 +214,16 @@ TEST_F(TcpSocketTest, ConnectSuccess) {
     EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
     EXPECT_EQ(handle.bind(bind_param), 0);
     EXPECT_EQ(handle.listen(10), 0);
-  });
-  client->once<InitEvent>([&](auto& event, auto& resource) -> void {
-    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
 
-    ran_order.push_back(2);
+      ran_order.push_back(2);
 
-    auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
-    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
-    handle.connect(connect_param);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
   });
 
   EXPECT_EQ(f.wait_for(std::chrono::milliseconds { 50000 }), std::future_status::ready);
@@ -167,4 +286,734 @@ TEST_F(TcpSocketTest, ConnectFailure) {
   EXPECT_EQ(client.use_count(), 1);
 }
 
+TEST_F(TcpSocketTest, WriteBufferChain) {
+  BufferChain buffers { createStringBuffer("HELLO "), createStringBuffer("WORLD") };
+  EXPECT_EQ(transfer(65432 + 2, buffers, createFixedSizeBuffer(1024), 11), "HELLO WORLD");
+}
+
+#if defined(__linux__)
+TEST_F(TcpSocketTest, ReadRingBuffer) {
+  std::string text;
+  for (int i = 0; text.size() < 100000; i++) {
+    text += std::to_string(i) + ",";
+  }
+  auto ring_buffer = createRingBuffer(4096);
+  ASSERT_NE(ring_buffer, nullptr);
+  EXPECT_EQ(transfer(65432 + 3, BufferChain { createStringBuffer(text) }, ring_buffer, text.size()), text);
+}
+#endif
+
+TEST_F(TcpSocketTest, ReadRingBufferWithBudget) {
+  std::string text;
+  for (int i = 0; text.size() < 65536; i++) {
+    text += std::to_string(i) + ",";
+  }
+  basic_params_.buffer_budget = BufferBudget::create(1048576);
+  auto budget = basic_params_.buffer_budget;
+  auto ring_buffer = createRingBuffer(basic_params_, 4096, kBufferRead);
+  ASSERT_NE(ring_buffer, nullptr);
+  EXPECT_EQ(budget->getUsage(kBufferRead), 4096);
+  // the retained rings are replaced by rings accounted to the budget
+  EXPECT_EQ(transfer(65432 + 9, BufferChain { createStringBuffer(text) }, ring_buffer, text.size(), true), text);
+  ring_buffer.reset();
+  EXPECT_EQ(budget->getTotalUsage(), 0);
+}
+
+TEST_F(TcpSocketTest, ReadStopsWhenRingBufferIsFull) {
+  std::string text;
+  for (int i = 0; text.size() < 65536; i++) {
+    text += std::to_string(i) + ",";
+  }
+  auto ring_buffer = createRingBuffer(4096);
+  ASSERT_NE(ring_buffer, nullptr);
+
+  std::promise<void> p_full;
+  std::future<void> f_full = p_full.get_future();
+  std::promise<std::string> p_received;
+  std::future<std::string> f_received = p_received.get_future();
+  std::atomic_int read_events(0);
+  std::atomic_int error_events(0);
+  bool consume = false;
+  std::string received;
+  std::shared_ptr<TCPSocket> accepted;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 8;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    accepted = TCPSocket::create(basic_params_);
+    accepted->init();
+    accepted->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    accepted->on<ErrorEvent>([&](auto& event, auto& resource) -> void {
+      error_events++;
+    });
+    accepted->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+      auto* buffer = event.buffer();
+      read_events++;
+      if (!consume) {
+        if (buffer->remaining() == buffer->capacity()) {
+          p_full.set_value();
+        }
+        return ;
+      }
+      received.append((const char*) buffer->data(), buffer->remaining());
+      buffer->position(buffer->position() + buffer->remaining());
+      if (received.size() >= text.size()) {
+        p_received.set_value(received);
+        resource.close();
+      }
+    });
+    server.accept(accepted);
+    accepted->read(ring_buffer);
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    handle.write(createStringBuffer(text), [](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      resource.close();
+    });
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_full.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  // more data is pending, but nothing more is read into the full ring
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+  int full_read_events = read_events.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds { 200 });
+  EXPECT_EQ(read_events.load(), full_read_events);
+  EXPECT_EQ(error_events.load(), 0);
+
+  basic_params_.loop->post([&]() -> void {
+    consume = true;
+    received.append((const char*) ring_buffer->data(), ring_buffer->remaining());
+    ring_buffer->position(ring_buffer->position() + ring_buffer->remaining());
+    accepted->read(ring_buffer);
+  });
+
+  ASSERT_EQ(f_received.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(f_received.get(), text);
+  EXPECT_EQ(error_events.load(), 0);
+}
+
+TEST_F(TcpSocketTest, RetainReadData) {
+  std::string text;
+  for (int i = 0; text.size() < 100000; i++) {
+    text += std::to_string(i) + ",";
+  }
+  EXPECT_EQ(transfer(65432 + 4, BufferChain { createStringBuffer(text) }, createFixedSizeBuffer(1024), text.size(), true), text);
+}
+
+TEST_F(TcpSocketTest, WriteSliceAsBuffer) {
+  std::string text;
+  for (int i = 0; text.size() < 4 * 1024 * 1024; i++) {
+    text += std::to_string(i) + ",";
+  }
+
+  std::promise<std::string> p_echoed;
+  std::future<std::string> f_echoed = p_echoed.get_future();
+  std::string echoed;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 11;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    socket->on<SocketReadEvent>([](auto& event, auto& resource) -> void {
+      // the slice and its buffer view are temporaries, only the pending write holds the read buffer
+      dynamic_cast<TCPSocket&>(resource).write(event.retain().asBuffer());
+    });
+    socket->on<SocketEndEvent>([](auto& event, auto& resource) -> void {
+      resource.close();
+    });
+    server.accept(socket);
+    socket->read(createFixedSizeBuffer(65536));
+  });
+  client->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+    auto* buffer = event.buffer();
+    echoed.append((const char*) buffer->data(), buffer->remaining());
+    buffer->position(buffer->position() + buffer->remaining());
+    if (echoed.size() >= text.size()) {
+      p_echoed.set_value(echoed);
+      resource.close();
+    }
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    // the echo is read after everything is sent, so the echo writes stay pending meanwhile
+    handle.write(createStringBuffer(text), [](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      dynamic_cast<TCPSocket&>(resource).read(createFixedSizeBuffer(65536));
+    });
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_echoed.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(f_echoed.get(), text);
+}
+
+TEST_F(TcpSocketTest, WriteMappedFile) {
+  const char* path = "jcu_unio_mapped_write_test.bin";
+  std::string content;
+  for (int i = 0; content.size() < 16 * 1024 * 1024; i++) {
+    content += std::to_string(i) + ",";
+  }
+  FILE* fp = fopen(path, "wb");
+  ASSERT_NE(fp, nullptr);
+  fwrite(content.data(), 1, content.size(), fp);
+  fclose(fp);
+
+  std::promise<std::string> p_received;
+  std::future<std::string> f_received = p_received.get_future();
+  std::string received;
+  bool mapped = true;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 12;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    socket->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+      auto* buffer = event.buffer();
+      received.append((const char*) buffer->data(), buffer->remaining());
+      buffer->position(buffer->position() + buffer->remaining());
+      if (received.size() >= content.size()) {
+        p_received.set_value(received);
+        resource.close();
+      }
+    });
+    server.accept(socket);
+    socket->read(createFixedSizeBuffer(65536));
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    // the pending write holds the only reference to the mapping
+    auto buffer = createMappedFileBuffer(path);
+    if (!buffer) {
+      mapped = false;
+      p_received.set_value({});
+      return ;
+    }
+    handle.write(std::move(buffer), [](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      resource.close();
+    });
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_received.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  if (mapped) {
+    EXPECT_TRUE(f_received.get() == content);
+  }
+  std::remove(path);
+}
+
+TEST_F(TcpSocketTest, PauseReadOnBufferPressure) {
+  std::string text;
+  for (int i = 0; text.size() < 1000000; i++) {
+    text += std::to_string(i) + ",";
+  }
+
+  BasicParams basic_params = basic_params_;
+  basic_params.buffer_budget = BufferBudget::create(1048576, 196608);
+  auto budget = basic_params.buffer_budget;
+
+  std::promise<std::string> p_received;
+  std::future<std::string> f_received = p_received.get_future();
+  std::string received;
+  std::vector<BufferSlice> slices;
+  int paused = 0;
+  int resumed = 0;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+  auto buffer = createStringBuffer(text);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 5;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params);
+    socket->init();
+    socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    socket->on<SocketPressureEvent>([&](auto& event, auto& resource) -> void {
+      if (!event.isPaused()) {
+        resumed++;
+        return ;
+      }
+      paused++;
+      EXPECT_TRUE(budget->isUnderPressure());
+      // the application consumes the retained data
+      for (const auto& slice : slices) {
+        received.append((const char*) slice.data(), slice.size());
+      }
+      slices.clear();
+      EXPECT_FALSE(budget->isUnderPressure());
+    });
+    socket->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+      slices.emplace_back(event.retain());
+      EXPECT_LE(budget->getTotalUsage(), budget->getLimit());
+      size_t received_size = received.size();
+      for (const auto& slice : slices) {
+        received_size += slice.size();
+      }
+      if (received_size >= text.size()) {
+        for (const auto& slice : slices) {
+          received.append((const char*) slice.data(), slice.size());
+        }
+        slices.clear();
+        p_received.set_value(received);
+        resource.close();
+      }
+    });
+    server.accept(socket);
+    socket->read(nullptr);
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    handle.write(buffer, [&](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      resource.close();
+    });
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_received.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(f_received.get(), text);
+  EXPECT_GT(paused, 0);
+  EXPECT_EQ(resumed, paused);
+  EXPECT_EQ(budget->getTotalUsage(), 0);
+}
+
+TEST_F(TcpSocketTest, SteadyStateWriteDoesNotAllocate) {
+  const int kWrites = 200;
+  const int kWarmup = 50;
+
+  std::promise<void> p_done;
+  std::future<void> f_done = p_done.get_future();
+  std::promise<void> p_closed;
+  std::future<void> f_closed = p_closed.get_future();
+  int completions = 0;
+  size_t allocations_before = 0;
+  size_t allocations = 0;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+  auto buffer = createStringBuffer("0123456789abcdef");
+  auto guard = std::make_shared<int>(0);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 6;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    socket->on<SocketReadEvent>([](auto& event, auto& resource) -> void {
+      auto* buffer = event.buffer();
+      buffer->position(buffer->position() + buffer->remaining());
+    });
+    socket->on<SocketEndEvent>([](auto& event, auto& resource) -> void {
+      resource.close();
+    });
+    server.accept(socket);
+    socket->read(createFixedSizeBuffer(4096));
+  });
+  server->on<CloseEvent>([&](auto& event, auto& resource) -> void {
+    p_closed.set_value();
+  });
+
+  std::function<void(TCPSocket&)> write_next = [&](TCPSocket& handle) -> void {
+    if (completions == kWarmup) {
+      allocations_before = getThreadAllocationCount();
+    }
+    if (completions == kWrites) {
+      allocations = getThreadAllocationCount() - allocations_before;
+      p_done.set_value();
+      handle.disconnect([](SocketDisconnectEvent& event, Resource& resource) -> void {
+        resource.close();
+      });
+      return ;
+    }
+    completions++;
+    // a shared_ptr and a few more, which std::function would allocate for
+    handle.write(buffer, [&write_next, guard, index = completions, buffer_ptr = buffer.get()](SocketWriteEvent& event, Resource& resource) -> void {
+      EXPECT_FALSE(event.hasError());
+      EXPECT_GT(index, 0);
+      EXPECT_NE(buffer_ptr, nullptr);
+      write_next(dynamic_cast<TCPSocket&>(resource));
+    });
+  };
+
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    write_next(dynamic_cast<TCPSocket&>(resource));
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_done.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  ASSERT_EQ(f_closed.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(completions, kWrites);
+  EXPECT_EQ(allocations, 0);
+}
+
+TEST_F(TcpSocketTest, StreamSink) {
+  class ReceiveSink : public StreamSink {
+   public:
+    std::string received;
+    std::function<void()> on_end;
+
+    void onRead(Buffer& buffer) override {
+      received.append((const char*) buffer.data(), buffer.remaining());
+      buffer.position(buffer.position() + buffer.remaining());
+    }
+
+    void onEnd() override {
+      on_end();
+    }
+  };
+
+  class WriteSink : public StreamSink {
+   public:
+    std::function<void(int status)> on_write_complete;
+
+    void onRead(Buffer& buffer) override {}
+
+    void onWriteComplete(int status) override {
+      on_write_complete(status);
+    }
+  };
+
+  std::promise<std::string> p_received;
+  std::future<std::string> f_received = p_received.get_future();
+  int read_events = 0;
+  int write_events = 0;
+  int write_completions = 0;
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+  auto receive_sink = std::make_shared<ReceiveSink>();
+  auto write_sink = std::make_shared<WriteSink>();
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 7;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    socket->on<SocketReadEvent>([&](auto& event, auto& resource) -> void {
+      read_events++;
+    });
+    socket->setSink(receive_sink);
+    receive_sink->on_end = [&, socket = socket.get(), server = &server]() -> void {
+      p_received.set_value(receive_sink->received);
+      socket->close();
+      server->close();
+    };
+    server.accept(socket);
+    socket->read(createFixedSizeBuffer(4));
+  });
+
+  client->setSink(write_sink);
+  client->on<SocketWriteEvent>([&](auto& event, auto& resource) -> void {
+    write_events++;
+  });
+  write_sink->on_write_complete = [&](int status) -> void {
+    EXPECT_EQ(status, 0);
+    if (++write_completions == 2) {
+      client->disconnect([](SocketDisconnectEvent& event, Resource& resource) -> void {
+        resource.close();
+      });
+    }
+  };
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    handle.write(createStringBuffer("HELLO "));
+    handle.write(createStringBuffer("WORLD"));
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_received.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  EXPECT_EQ(f_received.get(), "HELLO WORLD");
+  EXPECT_EQ(write_completions, 2);
+  EXPECT_EQ(read_events, 0);
+  EXPECT_EQ(write_events, 0);
+}
+
+TEST_F(TcpSocketTest, StreamSinkCancelsRead) {
+  class CancelSink : public StreamSink {
+   public:
+    std::shared_ptr<TCPSocket> socket;
+    std::string received;
+    std::atomic_int reads { 0 };
+    std::promise<void> p_read;
+
+    void onRead(Buffer& buffer) override {
+      received.append((const char*) buffer.data(), buffer.remaining());
+      buffer.position(buffer.position() + buffer.remaining());
+      // releases the read buffer during the delivery
+      socket->cancelRead();
+      if (reads++ == 0) {
+        p_read.set_value();
+      }
+    }
+  };
+
+  auto sink = std::make_shared<CancelSink>();
+  std::future<void> f_read = sink->p_read.get_future();
+  std::promise<void> p_closed;
+  std::future<void> f_closed = p_closed.get_future();
+
+  auto server = TCPSocket::create(basic_params_);
+  auto client = TCPSocket::create(basic_params_);
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 10;
+
+  server->once<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    sink->socket = TCPSocket::create(basic_params_);
+    sink->socket->init();
+    sink->socket->on<CloseEvent>([&server](auto& event, auto& resource) -> void {
+      server.close();
+    });
+    sink->socket->setSink(sink);
+    server.accept(sink->socket);
+    sink->socket->read(createFixedSizeBuffer(1024));
+  });
+  server->on<CloseEvent>([&](auto& event, auto& resource) -> void {
+    p_closed.set_value();
+  });
+  client->once<SocketConnectEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    handle.write(createStringBuffer("HELLO"));
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+      auto& handle = dynamic_cast<TCPSocket&>(resource);
+      auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+      EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+      handle.connect(connect_param);
+    });
+  });
+
+  ASSERT_EQ(f_read.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  basic_params_.loop->post([&]() -> void {
+    client->write(createStringBuffer("WORLD"));
+  });
+  // nothing more is read after cancelRead()
+  std::this_thread::sleep_for(std::chrono::milliseconds { 200 });
+  basic_params_.loop->post([&]() -> void {
+    EXPECT_EQ(sink->received, "HELLO");
+    EXPECT_EQ(sink->reads.load(), 1);
+    client->close();
+    sink->socket->close();
+  });
+  ASSERT_EQ(f_closed.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+  sink->socket.reset();
+}
+
+TEST_F(TcpSocketTest, ConnectionListenersDoNotAllocate) {
+  // the first accept warms up, then the second listener per event type is compared with the first
+  const int kConnections = 3;
+  const int kListeners[kConnections] = { 2, 1, 2 };
+  size_t allocations[kConnections] = { 0 };
+  int accepted = 0;
+  std::atomic_int closed_clients(0);
+  std::promise<void> p_closed;
+  std::future<void> f_closed = p_closed.get_future();
+  int events = 0;
+  int* counter = &events;
+
+  auto server = TCPSocket::create(basic_params_);
+  std::vector<std::shared_ptr<TCPSocket>> clients;
+  for (int i = 0; i < kConnections; i++) {
+    clients.emplace_back(TCPSocket::create(basic_params_));
+  }
+
+  const std::string address = "127.99.88.77";
+  const unsigned int port = 65432 + 13;
+
+  server->on<SocketListenEvent>([&](auto& event, auto& resource) -> void {
+    auto& server = dynamic_cast<TCPSocket&>(resource);
+    // on the loop thread, so the allocations of the test thread are not counted
+    size_t before = getThreadAllocationCount();
+    auto socket = TCPSocket::create(basic_params_);
+    socket->init();
+    server.accept(socket);
+    for (int i = 0; i < kListeners[accepted]; i++) {
+      socket->on<SocketReadEvent>([counter](auto& event, auto& resource) -> void { (*counter)++; });
+      socket->on<SocketEndEvent>([counter](auto& event, auto& resource) -> void { (*counter)++; });
+      socket->once<CloseEvent>([counter](auto& event, auto& resource) -> void { (*counter)++; });
+    }
+    allocations[accepted] = getThreadAllocationCount() - before;
+    socket->close();
+    if (++accepted == kConnections) {
+      server.close();
+    }
+  });
+  server->on<CloseEvent>([&](auto& event, auto& resource) -> void {
+    p_closed.set_value();
+  });
+  server->once<InitEvent>([&](auto& event, auto& resource) -> void {
+    auto& handle = dynamic_cast<TCPSocket&>(resource);
+    auto bind_param = std::make_shared<SockAddrBindParam<sockaddr_in>>();
+    EXPECT_EQ(uv_ip4_addr(address.c_str(), port, bind_param->getSockAddr()), 0);
+    EXPECT_EQ(handle.bind(bind_param), 0);
+    EXPECT_EQ(handle.listen(10), 0);
+    // connect after listening
+    for (auto& client : clients) {
+      client->on<CloseEvent>([&](auto& event, auto& resource) -> void {
+        closed_clients++;
+      });
+      client->once<SocketConnectEvent>([](auto& event, auto& resource) -> void {
+        resource.close();
+      });
+      client->once<InitEvent>([&](auto& event, auto& resource) -> void {
+        auto& handle = dynamic_cast<TCPSocket&>(resource);
+        auto connect_param = std::make_shared<SockAddrConnectParam<sockaddr_in>>();
+        EXPECT_EQ(uv_ip4_addr(address.c_str(), port, connect_param->getSockAddr()), 0);
+        handle.connect(connect_param);
+      });
+    }
+  });
+
+  ASSERT_EQ(f_closed.wait_for(std::chrono::milliseconds { 5000 }), std::future_status::ready);
+  for (int i = 0; (closed_clients.load() < kConnections) && (i < 50); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+  }
+  EXPECT_EQ(closed_clients.load(), kConnections);
+  std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); // wait for the callback complete
+
+  // the listeners are stored inline: a second listener per event type allocates nothing
+  EXPECT_GT(allocations[1], 0);
+  EXPECT_EQ(allocations[2], allocations[1]);
+  EXPECT_EQ(events, kListeners[0] + kListeners[1] + kListeners[2]);
+  clients.clear();
+}
+
 }
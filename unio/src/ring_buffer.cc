@@ -0,0 +1,160 @@
+/**
+ * @file	ring_buffer.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <jcu-unio/buffer.h>
+
+namespace jcu {
+namespace unio {
+
+#if defined(__linux__)
+
+class MirroredRingBuffer : public RingBuffer {
+ protected:
+  char* buf_;
+  size_t size_;
+  size_t head_;
+  size_t tail_;
+
+ public:
+  MirroredRingBuffer(char* buf, size_t size) :
+      buf_(buf),
+      size_(size),
+      head_(0),
+      tail_(0)
+  {}
+
+  ~MirroredRingBuffer() override {
+    ::munmap(buf_, size_ * 2);
+  }
+
+  static std::shared_ptr<MirroredRingBuffer> create(size_t size) {
+    size_t page_size = (size_t) ::sysconf(_SC_PAGESIZE);
+    size = ((size + page_size - 1) / page_size) * page_size;
+    if (size == 0) {
+      size = page_size;
+    }
+
+    int fd = ::memfd_create("jcu-unio-ring", MFD_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+    if (::ftruncate(fd, size) != 0) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    // reserve the address space, then map the same pages twice into it
+    char* buf = (char*) ::mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+    if (
+        (::mmap(buf, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+        (::mmap(buf + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    ) {
+      ::munmap(buf, size * 2);
+      ::close(fd);
+      return nullptr;
+    }
+    ::close(fd);
+
+    return std::make_shared<MirroredRingBuffer>(buf, size);
+  }
+
+  void *base() override {
+    return buf_;
+  }
+
+  const void *base() const override {
+    return buf_;
+  }
+
+  void *data() override {
+    return buf_ + head_;
+  }
+
+  const void *data() const override {
+    return buf_ + head_;
+  }
+
+  size_t capacity() const override {
+    return size_;
+  }
+
+  size_t position() const override {
+    return head_;
+  }
+
+  void position(size_t size) override {
+    head_ = size;
+    if (head_ >= size_) {
+      head_ -= size_;
+      tail_ -= size_;
+    }
+  }
+
+  void limit(size_t size) override {
+    tail_ = size;
+  }
+
+  size_t remaining() const override {
+    return tail_ - head_;
+  }
+
+  void flip() override {
+  }
+
+  void clear() override {
+    head_ = 0;
+    tail_ = 0;
+  }
+
+  size_t getExpandableSize() const override {
+    return size_;
+  }
+
+  void expand(size_t /* size */) override {
+  }
+
+  void *writableData() override {
+    return buf_ + tail_;
+  }
+
+  size_t writable() const override {
+    return size_ - (tail_ - head_);
+  }
+
+  void commit(size_t size) override {
+    tail_ += size;
+  }
+};
+
+std::shared_ptr<RingBuffer> createRingBuffer(size_t size) {
+  return MirroredRingBuffer::create(size);
+}
+
+#else
+
+std::shared_ptr<RingBuffer> createRingBuffer(size_t size) {
+  return nullptr;
+}
+
+#endif
+
+} // namespace unio
+} // namespace jcu
@@ -25,6 +25,9 @@ class TimerImpl : public Timer {
     void close() override {
       data_.reset();
     }
+    void forceClose() override {
+      data_->close();
+    }
     void setData(std::shared_ptr<TimerImpl> data) {
       data_ = data;
     }
@@ -114,7 +117,7 @@ class TimerImpl : public Timer {
 std::shared_ptr<Timer> jcu::unio::Timer::create(const BasicParams& basic_params) {
   std::shared_ptr<TimerImpl> instance(new TimerImpl(basic_params));
   instance->self_ = instance;
-  basic_params.loop->sendQueuedTask([instance]() -> void {
+  basic_params.loop->dispatch([instance]() -> void {
     instance->init();
   });
   return instance;
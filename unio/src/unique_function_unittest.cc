@@ -0,0 +1,99 @@
+/**
+ * @file	unique_function_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <memory>
+#include <string>
+
+#include "../test/unit_test_utils.h"
+#include <jcu-unio/unique_function.h>
+#include <jcu-unio/event.h>
+#include <jcu-unio/loop.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+TEST(UniqueFunctionTest, MoveOnlyCapture) {
+  std::unique_ptr<int> value(new int(10));
+  UniqueFunction<int(int)> fn([value = std::move(value)](int n) -> int {
+    return *value + n;
+  });
+  UniqueFunction<int(int)> moved(std::move(fn));
+  EXPECT_FALSE(fn);
+  ASSERT_TRUE(moved);
+  EXPECT_EQ(moved(5), 15);
+}
+
+TEST(UniqueFunctionTest, Empty) {
+  UniqueFunction<void()> fn;
+  EXPECT_FALSE(fn);
+  std::function<void()> empty;
+  UniqueFunction<void()> from_empty(empty);
+  EXPECT_FALSE(from_empty);
+  EXPECT_THROW(from_empty(), std::bad_function_call);
+}
+
+TEST(UniqueFunctionTest, InlineDoesNotAllocate) {
+  auto a = std::make_shared<int>(1);
+  auto b = std::make_shared<int>(2);
+  auto c = std::make_shared<int>(3);
+  int sum = 0;
+
+  size_t before = getAllocationCount();
+  {
+    UniqueFunction<void()> fn([a, b, c, &sum]() -> void {
+      sum = *a + *b + *c;
+    });
+    UniqueFunction<void()> moved(std::move(fn));
+    moved();
+    fn = std::move(moved);
+  }
+  EXPECT_EQ(getAllocationCount() - before, 0);
+  EXPECT_EQ(sum, 6);
+  // the captures are destroyed
+  EXPECT_EQ(a.use_count(), 1);
+}
+
+TEST(UniqueFunctionTest, LargeCallableOnHeap) {
+  struct Large {
+    char data[200];
+  } large;
+  std::fill(std::begin(large.data), std::end(large.data), 'a');
+  auto counter = std::make_shared<int>(0);
+  auto lambda = [large, counter]() -> int { return large.data[199] + (*counter)++; };
+  EXPECT_FALSE(UniqueFunction<int()>::isInline<decltype(lambda)>());
+
+  UniqueFunction<int()> fn(std::move(lambda));
+  UniqueFunction<int()> moved;
+  moved = std::move(fn);
+  EXPECT_EQ(moved(), 'a');
+  EXPECT_EQ(*counter, 1);
+  moved = nullptr;
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(UniqueFunctionTest, InternalTasksAreInline) {
+  std::shared_ptr<Resource> self;
+  std::function<void(InitEvent&, Resource&)> callback;
+  InitEvent* event = nullptr;
+  std::weak_ptr<Loop> weak_loop;
+  std::shared_ptr<Loop> loop;
+
+  // Handle::invokeInitEventCallback
+  auto init_event_task = [self, callback, &event]() mutable -> void {};
+  EXPECT_TRUE(QueuedTask_t::isInline<decltype(init_event_task)>());
+  // TCPSocket::read, Timer::create
+  auto self_task = [self]() -> void {};
+  EXPECT_TRUE(QueuedTask_t::isInline<decltype(self_task)>());
+  // TCPSocket::waitForBufferBudget
+  auto relief_task = [weak_loop, loop]() -> void {};
+  EXPECT_TRUE(UniqueFunction<void()>::isInline<decltype(relief_task)>());
+}
+
+} // namespace
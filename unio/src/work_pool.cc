@@ -0,0 +1,120 @@
+/**
+ * @file	work_pool.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <jcu-unio/work_pool.h>
+
+namespace jcu {
+namespace unio {
+
+class WorkPoolImpl : public WorkPool {
+ public:
+  /**
+   * shared with the threads, so that a detached thread outlives the pool
+   */
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<WorkTask_t> queue;
+    bool shutdown;
+
+    State() : shutdown(false) {}
+  };
+
+  std::shared_ptr<State> state_;
+  std::vector<std::thread> threads_;
+
+  explicit WorkPoolImpl(size_t threads) :
+      state_(std::make_shared<State>())
+  {
+    if (!threads) {
+      threads = std::thread::hardware_concurrency();
+    }
+    if (!threads) {
+      threads = 1;
+    }
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+      std::shared_ptr<State> state(state_);
+      threads_.emplace_back([state]() -> void {
+        run(*state);
+      });
+    }
+  }
+
+  ~WorkPoolImpl() override {
+    shutdown();
+  }
+
+  size_t getThreadCount() const override {
+    return threads_.size();
+  }
+
+  bool submit(WorkTask_t&& work) override {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (state_->shutdown) {
+        return false;
+      }
+      state_->queue.emplace_back(std::move(work));
+    }
+    state_->cond.notify_one();
+    return true;
+  }
+
+  void shutdown() override {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (state_->shutdown) {
+        return ;
+      }
+      state_->shutdown = true;
+    }
+    state_->cond.notify_all();
+    for (auto& thread : threads_) {
+      if (thread.get_id() == std::this_thread::get_id()) {
+        // the last reference is released by a work
+        thread.detach();
+      } else {
+        thread.join();
+      }
+    }
+  }
+
+  static void run(State& state) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    for (;;) {
+      state.cond.wait(lock, [&state]() -> bool {
+        return state.shutdown || !state.queue.empty();
+      });
+      if (state.queue.empty()) {
+        // shutdown
+        return ;
+      }
+      WorkTask_t work(std::move(state.queue.front()));
+      state.queue.pop_front();
+      lock.unlock();
+      work();
+      work.reset();
+      lock.lock();
+    }
+  }
+};
+
+std::shared_ptr<WorkPool> WorkPool::create(size_t threads) {
+  return std::make_shared<WorkPoolImpl>(threads);
+}
+
+} // namespace unio
+} // namespace jcu
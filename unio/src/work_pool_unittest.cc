@@ -0,0 +1,51 @@
+/**
+ * @file	work_pool_unittest.cc
+ * @author	Joseph Lee <joseph@jc-lab.net>
+ * @date	2026-10-17
+ * @copyright Copyright (C) 2021 jc-lab. All rights reserved.
+ *            This software may be modified and distributed under the terms
+ *            of the Apache License 2.0.  See the LICENSE file for details.
+ */
+
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "../test/unit_test_utils.h"
+#include <jcu-unio/work_pool.h>
+
+namespace {
+
+using namespace jcu::unio;
+
+TEST(WorkPoolTest, ThreadCount) {
+  auto pool = WorkPool::create(3);
+  EXPECT_EQ(pool->getThreadCount(), 3);
+  EXPECT_GE(WorkPool::create()->getThreadCount(), 1);
+}
+
+TEST(WorkPoolTest, ShutdownRunsSubmittedWork) {
+  auto pool = WorkPool::create(2);
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  std::atomic_int executed(0);
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(pool->submit([&]() -> void {
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_ids.insert(std::this_thread::get_id());
+      executed++;
+    }));
+  }
+  pool->shutdown();
+  EXPECT_EQ(executed.load(), 100);
+  EXPECT_EQ(thread_ids.count(std::this_thread::get_id()), 0);
+  EXPECT_LE(thread_ids.size(), 2);
+
+  EXPECT_FALSE(pool->submit([&]() -> void {
+    executed++;
+  }));
+  EXPECT_EQ(executed.load(), 100);
+}
+
+} // namespace
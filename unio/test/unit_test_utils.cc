@@ -7,14 +7,62 @@
  *            of the Apache License 2.0.  See the LICENSE file for details.
  */
 
+#include <cstdlib>
+#include <new>
+
 #include <jcu-unio/loop.h>
 #include <jcu-unio/log.h>
 
 #include "unit_test_utils.h"
 
+static std::atomic<size_t> allocation_count(0);
+static thread_local size_t thread_allocation_count = 0;
+
+static void* countedAllocate(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  thread_allocation_count++;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new(size_t size) {
+  return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+  return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
 namespace jcu {
 namespace unio {
 
+size_t getAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+size_t getThreadAllocationCount() {
+  return thread_allocation_count;
+}
+
 void LoopSupportTest::SetUp() {
   stopped_.store(false);
   basic_params_.logger = createDefaultLogger([](Logger::LogLevel level, const std::string& text) -> void {
@@ -57,6 +57,17 @@ namespace unio {
 
 class Loop;
 
+/**
+ * @return the number of global operator new calls (from any thread) since the start
+ */
+size_t getAllocationCount();
+
+/**
+ * @return the number of global operator new calls on the calling thread since it started,
+ *         not affected by the loop thread or other tests running meanwhile
+ */
+size_t getThreadAllocationCount();
+
 class LoopSupportTest : public ::testing::Test {
  public:
   BasicParams basic_params_;